@@ -1,17 +1,18 @@
 #version 330 core
-layout (location =0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec2 offset; // per instance
+layout (location = 2) in vec4 color; // per instance
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
 uniform mat4 projection;
-uniform vec2 offset;
-uniform vec4 color;
+uniform vec4 region; // <vec2 offset, vec2 scale> of the texture's part of its atlas page
 
 void main()
 {
 	float scale = 10.0f;
-	TexCoords = vertex.zw;
+	TexCoords = region.xy + vertex.zw * region.zw;
 	ParticleColor = color;
 	gl_Position = projection * vec4((vertex.xy * scale) + offset, 0.0, 1.0);
 }
\ No newline at end of file
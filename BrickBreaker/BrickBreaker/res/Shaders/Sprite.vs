@@ -5,9 +5,10 @@ out vec2 TexCoords;
 
 uniform mat4 model;
 uniform mat4 projection;
+uniform vec4 region; // <vec2 offset, vec2 scale> of the texture's part of its atlas page
 
 void main()
 {
-    TexCoords = vertex.zw;
+    TexCoords = region.xy + vertex.zw * region.zw;
     gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
 }
\ No newline at end of file
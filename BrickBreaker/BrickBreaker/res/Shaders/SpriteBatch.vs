@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 instanceRect; // <vec2 position, vec2 size>
+layout (location = 2) in vec4 instanceColor; // <vec3 color, float rotation>
+layout (location = 3) in vec4 instanceRegion; // <vec2 offset, vec2 scale> of the texture coordinates
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = instanceRegion.xy + vertex.zw * instanceRegion.zw;
+    SpriteColor = instanceColor.rgb;
+    // Rotate the quad around its center, then move it into place
+    vec2 local = (vertex.xy - 0.5) * instanceRect.zw;
+    float s = sin(instanceColor.a);
+    float c = cos(instanceColor.a);
+    local = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+    gl_Position = projection * vec4(instanceRect.xy + 0.5 * instanceRect.zw + local, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#pragma once
+
+// AllocationCounter counts the heap allocations of the benchmark executable.
+// Linking AllocationCounter.cpp replaces the global operator new and delete
+// with counting ones for the whole program; they live in a translation unit
+// of their own so the compiler never inlines them at a call site.
+class AllocationCounter
+{
+public:
+	// Number of times operator new was called so far
+	static unsigned long long Count();
+private:
+	// Private constructor, that is we do not want any actual counter objects. Its members and functions should be publicly available (static).
+	AllocationCounter();
+};
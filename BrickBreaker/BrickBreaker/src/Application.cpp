@@ -1,7 +1,17 @@
+#include <cstdlib>
 #include <iostream>
+#include <string>
 
 #include "Game.h"
 #include "Resource_Manager.h"
+#include "Benchmark.h"
+#include "Headless.h"
+#include "FixedTimestep.h"
+#include "RenderState.h"
+#include "Replay.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "ProfilerOverlay.h"
 
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
@@ -17,13 +27,79 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 const unsigned int SCREEN_WIDTH = 800;
 // Height of the screen
 const unsigned int SCREEN_HEIGHT = 600;
+// Default simulation steps per second, independent of the frame rate
+const float SIMULATION_RATE = 120.0f;
+// Most simulation steps run in one frame before the game slows down instead
+const unsigned int MAX_STEPS_PER_FRAME = 8;
+// Most textures uploaded per frame while resources load in the background
+const unsigned int UPLOADS_PER_FRAME = 2;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
+// Records the session when started with --record
+ReplayRecorder Recorder;
 
 glm::mat4 projection = glm::ortho(0.0f, 800.0f, 600.0f, 0.0f, -1.0f, 1.0f);
 
 int main(int argc, char* argv[])
 {
+	// Benchmarks run without a window
+	if (argc > 1 && std::string(argv[1]) == "--bench-particles")
+	{
+		Benchmark::ParticleUpdate();
+		return 0;
+	}
+	if (argc > 1 && std::string(argv[1]) == "--bench-levels")
+	{
+		Benchmark::LevelLoad(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000);
+		return 0;
+	}
+	// Simulation only, no window
+	if (argc > 1 && std::string(argv[1]) == "--headless")
+		return RunHeadless(argc, argv);
+
+	PROFILE_THREAD("Main");
+	float simulationRate = SIMULATION_RATE;
+	bool vsync = true;
+	const char *recordFile = nullptr;
+	const char *profileFile = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--sim-rate" && i + 1 < argc)
+		{
+			// The step is 1 / rate, so only positive rates make sense
+			float rate = static_cast<float>(std::atof(argv[++i]));
+			if (rate > 0.0f)
+				simulationRate = rate;
+			else
+				std::cerr << "ERROR::APPLICATION: Invalid simulation rate " << argv[i] << ", using " << SIMULATION_RATE << std::endl;
+		}
+		else if (arg == "--no-vsync")
+			vsync = false;
+		else if (arg == "--balls" && i + 1 < argc)
+		{
+			// Without a ball in play every step would reset the level
+			unsigned int balls = std::strtoul(argv[++i], nullptr, 10);
+			if (balls >= 1)
+				Breakout.BallCount = balls;
+			else
+				std::cerr << "ERROR::APPLICATION: Invalid ball count " << argv[i] << ", using " << Breakout.BallCount << std::endl;
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+			Breakout.Threads = std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--record" && i + 1 < argc)
+			recordFile = argv[++i];
+		else if (arg == "--profile" && i + 1 < argc)
+			profileFile = argv[++i];
+	}
+#if PROFILE_ENABLED
+	if (profileFile)
+		ProfilerOverlay::CaptureFile = profileFile;
+#else
+	if (profileFile)
+		std::cerr << "ERROR::PROFILER: Profiling is compiled out of this build, no trace will be written" << std::endl;
+#endif
+
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -35,6 +111,8 @@ int main(int argc, char* argv[])
 
 	GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Breakout", nullptr, nullptr);
 	glfwMakeContextCurrent(window);
+	// With vsync the frame rate follows the display (e.g. 240 Hz), the simulation rate stays fixed
+	glfwSwapInterval(vsync ? 1 : 0);
 
 	//glad: load all OpenGL function pointers
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -65,28 +143,48 @@ int main(int argc, char* argv[])
 
 	Breakout.State = GAME_PAUSE;
 
+	// The simulation always advances in steps of the same length, however long a frame takes
+	FixedTimestep timestep(simulationRate, MAX_STEPS_PER_FRAME);
+	if (recordFile && !Recorder.Begin(recordFile, Breakout, timestep.Step))
+		std::cerr << "ERROR::REPLAY: Can't write replay " << recordFile << std::endl;
+
 	// DeltaTime variables
-	float deltaTime = 0.0f;
-	float lastFrame = 0.0f;
+	double deltaTime = 0.0;
+	double lastFrame = glfwGetTime();
 
 	while (!glfwWindowShouldClose(window))
 	{
 		// Calculate delta time
-		float currentFrame = glfwGetTime();
+		double currentFrame = glfwGetTime();
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
+		PROFILE_FRAME();
+		PROFILE_GPU_FRAME();
 		glfwPollEvents();
+		// Move textures that finished loading in the background to the GPU
+		{
+			PROFILE_SCOPE("ProcessUploads");
+			ResourceManager::ProcessUploads(UPLOADS_PER_FRAME);
+		}
 
-		// Manage user input
-		Breakout.ProcessInput(deltaTime);
-
-		// Update game state
-		Breakout.Update(deltaTime);
+		// Manage user input and update game state in fixed steps
+		unsigned int steps = timestep.Advance(static_cast<float>(deltaTime));
+		for (unsigned int i = 0; i < steps; ++i)
+		{
+			if (Recorder.IsRecording())
+				Recorder.Step(Breakout);
+			else
+				Breakout.Step(timestep.Step);
+		}
 
-		// Render
+		// Render, blending between the last two simulated states
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
-		Breakout.Render();
+		Shader::ResetCounters();
+		RenderState::ResetCounters();
+		Breakout.Render(timestep.Alpha());
+		UniformCounters uniformCounters = Shader::Counters;
+		RenderStateCounters stateCounters = RenderState::Counters;
 
 		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
@@ -102,6 +200,12 @@ int main(int argc, char* argv[])
 
 			ImGui::Text("Currently Playing Level %d\n", Breakout.Level + 1);
 
+			ImGui::Text("Uniform lookups last frame: %u cached, %u missed\n", uniformCounters.CachedLookups, uniformCounters.Misses);
+
+			ImGui::Text("State changes last frame: %u issued, %u skipped\n", stateCounters.Issued, stateCounters.Skipped);
+
+			ImGui::Text("Resource lookups that found nothing: %u, stale handles used: %u\n", ResourceManager::Misses, ResourceManager::StaleHandles);
+
 			ImGui::Text("Select your level:");
 
 			if (ImGui::Button("Level 1"))
@@ -110,6 +214,7 @@ int main(int argc, char* argv[])
 				Breakout.Level = selectedLevel;
 				Breakout.ResetLevel();
 				Breakout.ResetPlayer();
+				Recorder.RecordLevel(selectedLevel);
 			}
 
 			if (ImGui::Button("Level 2"))
@@ -118,6 +223,7 @@ int main(int argc, char* argv[])
 				Breakout.Level = selectedLevel;
 				Breakout.ResetLevel();
 				Breakout.ResetPlayer();
+				Recorder.RecordLevel(selectedLevel);
 			}
 
 			if (ImGui::Button("Level 3"))
@@ -126,6 +232,7 @@ int main(int argc, char* argv[])
 				Breakout.Level = selectedLevel;
 				Breakout.ResetLevel();
 				Breakout.ResetPlayer();
+				Recorder.RecordLevel(selectedLevel);
 			}
 
 			if (ImGui::Button("Level 4"))
@@ -134,18 +241,39 @@ int main(int argc, char* argv[])
 				Breakout.Level = selectedLevel;
 				Breakout.ResetLevel();
 				Breakout.ResetPlayer();
+				Recorder.RecordLevel(selectedLevel);
 			}
 
 			ImGui::End();
 		}
 
-		ImGui::Render();
+#if PROFILE_ENABLED
+		ProfilerOverlay::Draw();
+#endif
+
+		{
+			PROFILE_SCOPE("ImGui");
+			PROFILE_GPU_SCOPE("GPU ImGui");
+			ImGui::Render();
 
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+			// ImGui sets GL state directly, so don't trust the shadowed state across it
+			RenderState::Invalidate();
+		}
 
-		glfwSwapBuffers(window);
+		{
+			// Includes waiting for vsync
+			PROFILE_SCOPE("SwapBuffers");
+			glfwSwapBuffers(window);
+		}
 	}
 
+	Recorder.End();
+#if PROFILE_ENABLED
+	if (profileFile && !Profiler::ExportChromeTrace(profileFile))
+		std::cerr << "ERROR::PROFILER: Can't write trace " << profileFile << std::endl;
+	GpuProfiler::Clear();
+#endif
 	// Delete all resources as loaded using the resource manager
 	ResourceManager::Clear();
 
@@ -175,6 +303,11 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 			Breakout.State = GAME_PAUSE;
 		else Breakout.State = GAME_ACTIVE;
 	}
+#if PROFILE_ENABLED
+	// Toggle the profiler overlay
+	if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+		ProfilerOverlay::Visible = !ProfilerOverlay::Visible;
+#endif
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
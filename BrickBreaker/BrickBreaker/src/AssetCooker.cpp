@@ -0,0 +1,94 @@
+#include "AssetCooker.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+
+#include "AssetPack.h"
+#include "GameLevel.h"
+
+int CookAssets(int argc, char* argv[])
+{
+	std::string root = "BrickBreaker/res";
+	std::string output = "BrickBreaker/res/assets.pack";
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--root" && i + 1 < argc)
+			root = argv[++i];
+		else if (arg == "--out" && i + 1 < argc)
+			output = argv[++i];
+	}
+
+	// Visit files in a fixed order so the same inputs always give the same pack
+	std::vector<std::string> files;
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+	{
+		if (it->is_regular_file())
+			files.push_back(it->path().generic_string());
+	}
+	if (error)
+	{
+		std::cerr << "ERROR::COOKER: Failed to read " << root << ": " << error.message() << std::endl;
+		return -1;
+	}
+	std::sort(files.begin(), files.end());
+
+	AssetPackWriter pack;
+	unsigned int textures = 0, texts = 0, levels = 0;
+	for (const std::string &file : files)
+	{
+		std::string extension = std::filesystem::path(file).extension().string();
+		if (extension == ".png" || extension == ".jpg")
+		{
+			// Keep the file's own channel count; the loader uses it for images loaded with or without alpha
+			int width, height, channels;
+			unsigned char *pixels = stbi_load(file.c_str(), &width, &height, &channels, 0);
+			if (!pixels || (channels != 3 && channels != 4))
+			{
+				std::cerr << "ERROR::COOKER: Skipping texture " << file << std::endl;
+				stbi_image_free(pixels);
+				continue;
+			}
+			pack.AddTexture(file, width, height, channels, pixels);
+			stbi_image_free(pixels);
+			++textures;
+		}
+		else if (extension == ".vs" || extension == ".frag" || extension == ".gs")
+		{
+			std::ifstream source(file, std::ios::binary);
+			std::stringstream text;
+			text << source.rdbuf();
+			pack.AddText(file, text.str());
+			++texts;
+		}
+		else if (extension == ".lvl")
+		{
+			std::vector<unsigned int> tiles;
+			unsigned int width, height;
+			if (!GameLevel::ReadTiles(file.c_str(), tiles, width, height))
+			{
+				std::cerr << "ERROR::COOKER: Skipping level " << file << std::endl;
+				continue;
+			}
+			pack.AddLevel(file, width, height, tiles);
+			++levels;
+		}
+	}
+
+	if (!pack.Write(output.c_str()))
+	{
+		std::cerr << "ERROR::COOKER: Failed to write " << output << std::endl;
+		return -1;
+	}
+	std::cout << "Cooked " << textures << " textures, " << texts << " shader sources and "
+		<< levels << " levels into " << output << std::endl;
+	return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Cooks every asset under a resource directory into one asset pack, so the
+// game can skip image decoding, shader file reads and level parsing on
+// startup. Images (.png, .jpg) are stored decoded, shader sources (.vs,
+// .frag, .gs) as text and levels (.lvl) as tile grids, each named by its
+// path as the game loads it. Options:
+//   --root DIR   resource directory, as seen from the game's working directory (default BrickBreaker/res)
+//   --out FILE   pack to write (default BrickBreaker/res/assets.pack)
+int CookAssets(int argc, char* argv[]);
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+// Identifies asset packs and their layout
+const char PACK_MAGIC[4] = { 'B', 'B', 'P', 'K' };
+const uint32_t PACK_VERSION = 1;
+// Alignment of every entry's data within the pack
+const uint64_t PACK_ALIGNMENT = 16;
+
+namespace
+{
+	// Whether an entry holds exactly the bytes its readers take from it
+	bool entrySizeValid(const PackEntry &entry, const unsigned char *data)
+	{
+		uint64_t area = static_cast<uint64_t>(entry.Width) * entry.Height;
+		switch (entry.Type)
+		{
+		case PACK_TEXTURE:
+			return entry.Channels >= 1 && entry.Channels <= 4
+				&& entry.Size % entry.Channels == 0 && entry.Size / entry.Channels == area;
+		case PACK_TEXT:
+			return entry.Size > 0 && data[entry.Offset + entry.Size - 1] == '\0';
+		case PACK_LEVEL:
+			// Tiles are read in place as uint32_t
+			return entry.Offset % alignof(uint32_t) == 0
+				&& entry.Size % sizeof(uint32_t) == 0 && entry.Size / sizeof(uint32_t) == area;
+		default:
+			return true;
+		}
+	}
+}
+
+AssetPack::AssetPack()
+	: entries(nullptr), names(nullptr), entryCount(0)
+{
+
+}
+
+bool AssetPack::Open(const char *file)
+{
+	this->Close();
+	if (!this->file.Open(file))
+		return false;
+	const unsigned char *data = this->file.Data;
+	uint64_t size = this->file.Size;
+	PackHeader header;
+	if (size < sizeof(header))
+	{
+		this->Close();
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	uint64_t tableSize = static_cast<uint64_t>(header.EntryCount) * sizeof(PackEntry);
+	if (std::memcmp(header.Magic, PACK_MAGIC, 4) != 0 || header.Version != PACK_VERSION
+		|| header.TableOffset % alignof(PackEntry) != 0 || header.TableOffset > size
+		|| tableSize + header.NamesSize > size - header.TableOffset)
+	{
+		this->Close();
+		return false;
+	}
+	const PackEntry *entries = reinterpret_cast<const PackEntry *>(data + header.TableOffset);
+	const char *names = reinterpret_cast<const char *>(data + header.TableOffset + tableSize);
+	// Check every entry once here so lookups can trust the table
+	for (uint32_t i = 0; i < header.EntryCount; ++i)
+	{
+		const PackEntry &entry = entries[i];
+		if (static_cast<uint64_t>(entry.NameOffset) + entry.NameLength > header.NamesSize
+			|| entry.Offset > size || entry.Size > size - entry.Offset
+			|| !entrySizeValid(entry, data))
+		{
+			this->Close();
+			return false;
+		}
+	}
+	this->entries = entries;
+	this->names = names;
+	this->entryCount = header.EntryCount;
+	return true;
+}
+
+void AssetPack::Close()
+{
+	this->file.Close();
+	this->entries = nullptr;
+	this->names = nullptr;
+	this->entryCount = 0;
+}
+
+bool AssetPack::IsOpen() const
+{
+	return this->entries != nullptr;
+}
+
+const PackEntry *AssetPack::Find(std::string_view name, PackEntryType type) const
+{
+	const PackEntry *end = this->entries + this->entryCount;
+	const PackEntry *entry = std::lower_bound(this->entries, end, name,
+		[this](const PackEntry &entry, std::string_view name) { return this->Name(entry) < name; });
+	if (entry == end || this->Name(*entry) != name || entry->Type != type)
+		return nullptr;
+	return entry;
+}
+
+const unsigned char *AssetPack::Data(const PackEntry &entry) const
+{
+	return this->file.Data + entry.Offset;
+}
+
+std::string_view AssetPack::Name(const PackEntry &entry) const
+{
+	return std::string_view(this->names + entry.NameOffset, entry.NameLength);
+}
+
+void AssetPackWriter::AddTexture(const std::string &name, unsigned int width, unsigned int height, unsigned int channels, const unsigned char *pixels)
+{
+	this->add(name, PACK_TEXTURE, width, height, channels, pixels, static_cast<size_t>(width) * height * channels);
+}
+
+void AssetPackWriter::AddText(const std::string &name, const std::string &text)
+{
+	// Keep the terminating zero so the text can be used as a C string straight from the pack
+	this->add(name, PACK_TEXT, 0, 0, 0, text.c_str(), text.size() + 1);
+}
+
+void AssetPackWriter::AddLevel(const std::string &name, unsigned int width, unsigned int height, const std::vector<unsigned int> &tiles)
+{
+	std::vector<uint32_t> codes(tiles.begin(), tiles.end());
+	this->add(name, PACK_LEVEL, width, height, 1, codes.data(), codes.size() * sizeof(uint32_t));
+}
+
+void AssetPackWriter::add(const std::string &name, PackEntryType type, unsigned int width, unsigned int height, unsigned int channels, const void *data, size_t size)
+{
+	Item item;
+	item.Name = name;
+	item.Entry = { type, 0, static_cast<uint32_t>(name.size()), width, height, channels, 0, size };
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+	item.Data.assign(bytes, bytes + size);
+	this->items.push_back(std::move(item));
+}
+
+bool AssetPackWriter::Write(const char *file) const
+{
+	// The table is sorted by name for binary search
+	std::vector<const Item *> sorted;
+	for (const Item &item : this->items)
+		sorted.push_back(&item);
+	std::sort(sorted.begin(), sorted.end(), [](const Item *a, const Item *b) { return a->Name < b->Name; });
+
+	// Lay out the data after the header, then the table and names
+	std::vector<PackEntry> table;
+	std::string names;
+	uint64_t offset = sizeof(PackHeader);
+	for (const Item *item : sorted)
+	{
+		offset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+		PackEntry entry = item->Entry;
+		entry.NameOffset = static_cast<uint32_t>(names.size());
+		entry.Offset = offset;
+		table.push_back(entry);
+		names += item->Name;
+		offset += item->Data.size();
+	}
+	PackHeader header;
+	std::memcpy(header.Magic, PACK_MAGIC, 4);
+	header.Version = PACK_VERSION;
+	header.EntryCount = static_cast<uint32_t>(table.size());
+	header.NamesSize = static_cast<uint32_t>(names.size());
+	header.TableOffset = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+
+	std::ofstream out(file, std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	const char padding[PACK_ALIGNMENT] = {};
+	uint64_t written = sizeof(header);
+	for (unsigned int i = 0; i < sorted.size(); ++i)
+	{
+		out.write(padding, table[i].Offset - written);
+		out.write(reinterpret_cast<const char *>(sorted[i]->Data.data()), sorted[i]->Data.size());
+		written = table[i].Offset + sorted[i]->Data.size();
+	}
+	out.write(padding, header.TableOffset - written);
+	out.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(PackEntry));
+	out.write(names.data(), names.size());
+	return static_cast<bool>(out);
+}
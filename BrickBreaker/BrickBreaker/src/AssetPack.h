@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Kinds of assets a pack holds
+enum PackEntryType : uint32_t
+{
+	PACK_TEXTURE = 1, // Decoded pixels, Width x Height x Channels bytes, rows top to bottom
+	PACK_TEXT = 2,    // File contents followed by a terminating zero, e.g. shader source
+	PACK_LEVEL = 3    // Width x Height tile codes as uint32_t, row-major
+};
+
+// Pack file header
+struct PackHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t EntryCount;
+	uint32_t NamesSize;
+	uint64_t TableOffset; // Entries, then their names
+};
+
+// Pack table entry; entries are sorted by name
+struct PackEntry
+{
+	uint32_t Type;
+	uint32_t NameOffset;
+	uint32_t NameLength;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Channels;
+	uint64_t Offset;
+	uint64_t Size;
+};
+
+// AssetPack gives access to an asset pack written by the asset cooker. The
+// pack is memory mapped and used in place: entries are found by binary
+// search over the sorted table and their data is handed out as pointers
+// into the mapping, so loading an asset is a lookup rather than a decode.
+// Assets are named by the path of the file they were cooked from.
+class AssetPack
+{
+public:
+	AssetPack();
+	// Maps and validates a pack; false if it's missing or malformed, including
+	// entries whose data doesn't match their type and dimensions
+	bool Open(const char *file);
+	void Close();
+	bool IsOpen() const;
+	// Returns the entry with the given name and type, or nullptr
+	const PackEntry *Find(std::string_view name, PackEntryType type) const;
+	// Returns an entry's data, valid while the pack is open
+	const unsigned char *Data(const PackEntry &entry) const;
+	std::string_view Name(const PackEntry &entry) const;
+private:
+	MappedFile file;
+	const PackEntry *entries;
+	const char *names;
+	uint32_t entryCount;
+};
+
+// AssetPackWriter collects cooked assets and writes them as one pack file
+class AssetPackWriter
+{
+public:
+	void AddTexture(const std::string &name, unsigned int width, unsigned int height, unsigned int channels, const unsigned char *pixels);
+	void AddText(const std::string &name, const std::string &text);
+	void AddLevel(const std::string &name, unsigned int width, unsigned int height, const std::vector<unsigned int> &tiles);
+	// Writes all added assets; false if the file can't be written
+	bool Write(const char *file) const;
+private:
+	struct Item
+	{
+		std::string Name;
+		PackEntry Entry;
+		std::vector<unsigned char> Data;
+	};
+	std::vector<Item> items;
+	void add(const std::string &name, PackEntryType type, unsigned int width, unsigned int height, unsigned int channels, const void *data, size_t size);
+};
\ No newline at end of file
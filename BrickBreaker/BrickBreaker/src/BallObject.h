@@ -10,7 +10,7 @@ public:
 	bool Stuck;
 
 	BallObject();
-	BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite);
+	BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, TextureHandle sprite);
 
 	glm::vec2 Move(float dt, unsigned int window_width);
 	void Reset(glm::vec2 position, glm::vec2 velocity);
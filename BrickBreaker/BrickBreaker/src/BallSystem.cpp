@@ -0,0 +1,189 @@
+#include "BallSystem.h"
+
+#include "Game.h"
+#include "Collision.h"
+
+BallSystem::BallSystem(float radius)
+	: Radius(radius), Count(0)
+{
+
+}
+
+unsigned int BallSystem::Add(glm::vec2 position, glm::vec2 velocity, bool stuck)
+{
+	this->PositionX.push_back(position.x);
+	this->PositionY.push_back(position.y);
+	this->VelocityX.push_back(velocity.x);
+	this->VelocityY.push_back(velocity.y);
+	this->PreviousX.push_back(position.x);
+	this->PreviousY.push_back(position.y);
+	this->Stuck.push_back(stuck);
+	return this->Count++;
+}
+
+void BallSystem::Remove(unsigned int index)
+{
+	unsigned int last = this->Count - 1;
+	this->PositionX[index] = this->PositionX[last];
+	this->PositionY[index] = this->PositionY[last];
+	this->VelocityX[index] = this->VelocityX[last];
+	this->VelocityY[index] = this->VelocityY[last];
+	this->PreviousX[index] = this->PreviousX[last];
+	this->PreviousY[index] = this->PreviousY[last];
+	this->Stuck[index] = this->Stuck[last];
+	this->PositionX.pop_back();
+	this->PositionY.pop_back();
+	this->VelocityX.pop_back();
+	this->VelocityY.pop_back();
+	this->PreviousX.pop_back();
+	this->PreviousY.pop_back();
+	this->Stuck.pop_back();
+	--this->Count;
+}
+
+void BallSystem::Clear()
+{
+	this->PositionX.clear();
+	this->PositionY.clear();
+	this->VelocityX.clear();
+	this->VelocityY.clear();
+	this->PreviousX.clear();
+	this->PreviousY.clear();
+	this->Stuck.clear();
+	this->Count = 0;
+}
+
+void BallSystem::SavePrevious()
+{
+	this->PreviousX = this->PositionX;
+	this->PreviousY = this->PositionY;
+}
+
+void BallSystem::Sweep(unsigned int first, unsigned int last, float dt, const GameLevel &level, const GameObject &player,
+	float width, std::vector<BrickHit> &hits, std::vector<unsigned int> &candidates)
+{
+	const float radius = this->Radius;
+	const glm::vec2 size(radius * 2.0f);
+	for (unsigned int ball = first; ball < last; ++ball)
+	{
+		// A stuck ball moves with the paddle
+		if (this->Stuck[ball])
+			continue;
+		glm::vec2 position(this->PositionX[ball], this->PositionY[ball]);
+		glm::vec2 velocity(this->VelocityX[ball], this->VelocityY[ball]);
+		float remaining = dt;
+		for (unsigned int bounce = 0; bounce < MAX_BALL_BOUNCES && remaining > 0.0f; ++bounce)
+		{
+			glm::vec2 motion = velocity * remaining;
+			glm::vec2 center = position + radius;
+			// Find the earliest contact along the motion; on ties the first one found wins
+			SweepHit contact = { false, 1.0f, glm::vec2(0.0f), 0.0f };
+			int hitBrick = -1;
+			bool hitPlayer = false;
+			// Only test the bricks on tiles the ball sweeps over during the rest of this step
+			glm::vec2 target = position + motion;
+			level.QueryBricks(glm::min(position, target), glm::max(position, target) + size, candidates);
+			for (unsigned int index : candidates)
+			{
+				glm::vec2 box = level.BrickPositions[index];
+				SweepHit hit = SweepCircleAABB(center, radius, motion, box, box + level.TileSize);
+				if (hit.Hit && hit.Time < contact.Time)
+				{
+					contact = hit;
+					hitBrick = index;
+				}
+			}
+			SweepHit hit = SweepCircleAABB(center, radius, motion, player.Position, player.Position + player.Size);
+			if (hit.Hit && hit.Time < contact.Time)
+			{
+				contact = hit;
+				hitBrick = -1;
+				hitPlayer = true;
+			}
+			// Left, right and top walls; the bottom is open
+			if (motion.x < 0.0f && center.x + motion.x < radius)
+			{
+				float t = glm::max((radius - center.x) / motion.x, 0.0f);
+				if (t < contact.Time)
+				{
+					contact = { true, t, glm::vec2(1.0f, 0.0f), 0.0f };
+					hitBrick = -1;
+					hitPlayer = false;
+				}
+			}
+			else if (motion.x > 0.0f && center.x + motion.x > width - radius)
+			{
+				float t = glm::max((width - radius - center.x) / motion.x, 0.0f);
+				if (t < contact.Time)
+				{
+					contact = { true, t, glm::vec2(-1.0f, 0.0f), 0.0f };
+					hitBrick = -1;
+					hitPlayer = false;
+				}
+			}
+			if (motion.y < 0.0f && center.y + motion.y < radius)
+			{
+				float t = glm::max((radius - center.y) / motion.y, 0.0f);
+				if (t < contact.Time)
+				{
+					contact = { true, t, glm::vec2(0.0f, 1.0f), 0.0f };
+					hitBrick = -1;
+					hitPlayer = false;
+				}
+			}
+
+			if (!contact.Hit)
+			{
+				position = target;
+				break;
+			}
+			// Advance to the contact and push out of any overlap we started in
+			position += motion * contact.Time + contact.Normal * contact.Penetration;
+			remaining -= remaining * contact.Time;
+			if (hitPlayer)
+			{
+				// Check where it hit the board, and change velocity based on where it hit the board
+				float centerBoard = player.Position.x + player.Size.x / 2.0f;
+				float distance = (position.x + radius) - centerBoard;
+				float percentage = distance / (player.Size.x / 2.0f);
+				// Then move accordingly
+				float strength = 2.0f;
+				glm::vec2 oldVelocity = velocity;
+				velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
+				velocity = glm::normalize(velocity) * glm::length(oldVelocity);
+				// Fix sticky paddle
+				velocity.y = -1.0f * abs(velocity.y);
+				continue;
+			}
+			// Solid bricks are never destroyed, so they don't need to be recorded
+			if (hitBrick >= 0 && !(level.BrickFlags[hitBrick] & BRICK_SOLID))
+				hits.push_back({ static_cast<unsigned int>(hitBrick), ball });
+			// Reflect the velocity about the contact normal
+			float approach = glm::dot(velocity, contact.Normal);
+			if (approach < 0.0f)
+				velocity -= 2.0f * approach * contact.Normal;
+		}
+		this->PositionX[ball] = position.x;
+		this->PositionY[ball] = position.y;
+		this->VelocityX[ball] = velocity.x;
+		this->VelocityY[ball] = velocity.y;
+	}
+}
+
+unsigned int BallSystem::RemoveBelow(float height)
+{
+	unsigned int removed = 0;
+	unsigned int ball = 0;
+	while (ball < this->Count)
+	{
+		if (this->PositionY[ball] >= height)
+		{
+			// The last ball moves into this slot, so check the slot again
+			this->Remove(ball);
+			++removed;
+		}
+		else
+			++ball;
+	}
+	return removed;
+}
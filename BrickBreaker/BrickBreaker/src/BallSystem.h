@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "GameLevel.h"
+#include "GameObject.h"
+
+// A ball reaching a brick during a step
+struct BrickHit
+{
+	unsigned int Brick;
+	unsigned int Ball;
+};
+
+// BallSystem stores every ball in play as a structure of arrays and moves
+// them with batch kernels instead of per-object calls. All balls share one
+// radius. Bricks are only read while balls move; contacts are recorded as
+// BrickHits and applied afterwards, so the outcome of a step doesn't depend
+// on the order the balls are processed in.
+class BallSystem
+{
+public:
+	// Ball state, one entry per ball; positions are the top-left corner like GameObject::Position
+	std::vector<float> PositionX, PositionY;
+	std::vector<float> VelocityX, VelocityY;
+	// Positions at the start of the current step, used to interpolate rendering
+	std::vector<float> PreviousX, PreviousY;
+	// Non-zero while a ball rests on the paddle
+	std::vector<unsigned char> Stuck;
+	float Radius;
+	unsigned int Count;
+
+	BallSystem(float radius);
+	// Adds a ball and returns its index
+	unsigned int Add(glm::vec2 position, glm::vec2 velocity, bool stuck);
+	// Removes a ball by moving the last ball into its slot
+	void Remove(unsigned int index);
+	// Removes all balls
+	void Clear();
+	// Remembers the current positions as the start of a new step
+	void SavePrevious();
+	// Moves balls [first, last) through a step of dt, bouncing them off the walls, the paddle
+	// and every brick that was live at the start of the step. Brick contacts are appended to hits.
+	void Sweep(unsigned int first, unsigned int last, float dt, const GameLevel &level, const GameObject &player,
+		float width, std::vector<BrickHit> &hits, std::vector<unsigned int> &candidates);
+	// Removes every ball whose top edge is at or below height and returns how many were removed
+	unsigned int RemoveBelow(float height);
+};
\ No newline at end of file
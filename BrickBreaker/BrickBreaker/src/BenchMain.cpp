@@ -0,0 +1,7 @@
+#include "BenchmarkSuite.h"
+
+// Entry point of the benchmark suite: no window or GL context
+int main(int argc, char* argv[])
+{
+	return RunBenchmarks(argc, argv);
+}
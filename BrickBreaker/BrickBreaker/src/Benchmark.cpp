@@ -0,0 +1,188 @@
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ParticlePool.h"
+#include "GameLevel.h"
+
+namespace
+{
+	// The array-of-structs particle the pool replaced, kept as the baseline
+	struct Particle
+	{
+		glm::vec2 Position, Velocity;
+		glm::vec4 Color;
+		float	  Life;
+
+		Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
+	};
+
+	// The original per-particle update loop
+	void updateParticles(std::vector<Particle> &particles, float dt)
+	{
+		for (Particle &p : particles)
+		{
+			p.Life -= dt; // Reduce life
+			if (p.Life > 0.0f)
+			{
+				// Particle is alive, thus update
+				p.Position -= p.Velocity * dt;
+				p.Color.a -= dt * 2.5f;
+			}
+		}
+	}
+
+	// The original level parser: a stream per line and a vector per row, copied into the tile grid
+	bool readTilesStream(const char *file, std::vector<unsigned int> &tiles, unsigned int &width, unsigned int &height)
+	{
+		unsigned int tileCode;
+		std::string line;
+		std::ifstream fstream(file);
+		std::vector<std::vector<unsigned int>> tileData;
+		if (!fstream)
+			return false;
+		while (std::getline(fstream, line)) // Reach each line from level file
+		{
+			std::istringstream sstream(line);
+			std::vector<unsigned int> row;
+			while (sstream >> tileCode) // Reach each word separated by spaces
+				row.push_back(tileCode);
+			tileData.push_back(row);
+		}
+		if (tileData.empty() || tileData[0].empty())
+			return false;
+		height = static_cast<unsigned int>(tileData.size());
+		width = static_cast<unsigned int>(tileData[0].size());
+		tiles.assign(width * height, 0);
+		for (unsigned int y = 0; y < height; ++y)
+			std::copy_n(tileData[y].begin(), std::min<size_t>(tileData[y].size(), width), tiles.begin() + y * width);
+		return true;
+	}
+
+	float randomFloat(float min, float max)
+	{
+		return min + (max - min) * (rand() / static_cast<float>(RAND_MAX));
+	}
+
+	double elapsedNs(std::chrono::steady_clock::time_point start)
+	{
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count());
+	}
+}
+
+void Benchmark::ParticleUpdate()
+{
+	const unsigned int sizes[] = { 1000, 100000, 1000000 };
+	const unsigned int steps = 100; // Updates per repetition
+	const float dt = 0.001f; // Lives are in [0, 1], so roughly a tenth of the particles die per repetition
+
+	std::cout << "Particle update (SIMD width " << ParticlePool::SimdWidth << ")" << std::endl;
+	for (unsigned int size : sizes)
+	{
+		// Repeat small pools so every size does a comparable amount of work
+		unsigned int repetitions = glm::max(1u, 10000000u / (size * steps));
+		std::vector<Particle> initial(size);
+		for (Particle &p : initial)
+		{
+			p.Position = glm::vec2(randomFloat(0.0f, 800.0f), randomFloat(0.0f, 600.0f));
+			p.Velocity = glm::vec2(randomFloat(-50.0f, 50.0f), randomFloat(-50.0f, 50.0f));
+			p.Color = glm::vec4(randomFloat(0.5f, 1.5f));
+			p.Life = randomFloat(0.0f, 1.0f);
+		}
+
+		double aosNs = 0.0, soaNs = 0.0;
+		for (unsigned int r = 0; r < repetitions; ++r)
+		{
+			std::vector<Particle> particles = initial;
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned int s = 0; s < steps; ++s)
+				updateParticles(particles, dt);
+			aosNs += elapsedNs(start);
+
+			ParticlePool pool(size);
+			for (unsigned int i = 0; i < size; ++i)
+			{
+				const Particle &p = initial[i];
+				pool.PositionX[i] = p.Position.x;
+				pool.PositionY[i] = p.Position.y;
+				pool.VelocityX[i] = p.Velocity.x;
+				pool.VelocityY[i] = p.Velocity.y;
+				pool.ColorR[i] = p.Color.r;
+				pool.ColorG[i] = p.Color.g;
+				pool.ColorB[i] = p.Color.b;
+				pool.ColorA[i] = p.Color.a;
+				pool.Life[i] = p.Life;
+			}
+			pool.Count = size;
+			start = std::chrono::steady_clock::now();
+			for (unsigned int s = 0; s < steps; ++s)
+				pool.Update(dt);
+			soaNs += elapsedNs(start);
+		}
+
+		double updates = static_cast<double>(size) * steps * repetitions;
+		std::cout << "  " << size << " particles: AoS " << aosNs / updates << " ns/particle, SoA "
+			<< soaNs / updates << " ns/particle (" << aosNs / soaNs << "x)" << std::endl;
+	}
+}
+
+void Benchmark::LevelLoad(unsigned int size /*= 4000*/)
+{
+	// Random tile codes, five in six of them bricks, like a densely filled level
+	std::string file = (std::filesystem::temp_directory_path() / "BrickBreakerBench.lvl").string();
+	{
+		std::ofstream out(file, std::ios::binary);
+		std::string line;
+		for (unsigned int y = 0; y < size; ++y)
+		{
+			line.clear();
+			for (unsigned int x = 0; x < size; ++x)
+			{
+				line += static_cast<char>('0' + rand() % 6);
+				line += x + 1 < size ? ' ' : '\n';
+			}
+			out << line;
+		}
+	}
+	std::cout << "Level load (" << size << " x " << size << " tiles, "
+		<< std::filesystem::file_size(file) / (1024 * 1024) << " MB)" << std::endl;
+
+	// Each level is destroyed outside of the timed part
+	unsigned int streamBricks = 0, mappedBricks = 0;
+	double streamNs = 0.0, mappedNs = 0.0;
+	{
+		GameLevel level;
+		auto start = std::chrono::steady_clock::now();
+		LevelTiles tiles = { {}, 0, 0 };
+		readTilesStream(file.c_str(), tiles.Tiles, tiles.Width, tiles.Height);
+		level.Load(tiles, 800, 300);
+		streamNs = elapsedNs(start);
+		streamBricks = level.BrickCount;
+	}
+	{
+		GameLevel level;
+		auto start = std::chrono::steady_clock::now();
+		level.Load(file.c_str(), 800, 300);
+		mappedNs = elapsedNs(start);
+		mappedBricks = level.BrickCount;
+	}
+	std::remove(file.c_str());
+
+	double tiles = static_cast<double>(size) * size;
+	std::cout << "  stream parser: " << streamNs / 1e6 << " ms (" << streamNs / tiles << " ns/tile)" << std::endl;
+	std::cout << "  mapped parser: " << mappedNs / 1e6 << " ms (" << mappedNs / tiles << " ns/tile, "
+		<< streamNs / mappedNs << "x)" << std::endl;
+	if (streamBricks != mappedBricks)
+		std::cout << "  MISMATCH: " << streamBricks << " bricks from the stream parser, " << mappedBricks << " from the mapped parser" << std::endl;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// Microbenchmarks for CPU hot paths. They need no window or GL context and
+// are run from the command line, e.g. "BrickBreaker --bench-particles".
+namespace Benchmark
+{
+	// Compares the structure-of-arrays particle pool against the original
+	// array-of-structs update loop at 1k, 100k and 1M particles
+	void ParticleUpdate();
+	// Compares loading a generated size x size level with the memory-mapped
+	// two-pass parser against the original line-by-line stream parser. Memory
+	// grows with size squared: 4000 peaks at about 450 MB, 10000 at about 3 GB.
+	void LevelLoad(unsigned int size = 4000);
+}
\ No newline at end of file
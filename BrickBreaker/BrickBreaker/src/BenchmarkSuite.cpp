@@ -0,0 +1,599 @@
+#include "BenchmarkSuite.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "BallObject.h"
+#include "BallSystem.h"
+#include "Collision.h"
+#include "GameLevel.h"
+#include "GameObject.h"
+#include "ParticlePool.h"
+#include "Random.h"
+#include "AllocationCounter.h"
+
+// Repetitions every case runs at least, however long they take
+const unsigned int MIN_REPETITIONS = 3;
+// Objects the per-object cases cycle through, small enough to stay in cache
+const unsigned int OBJECT_COUNT = 1024;
+// Passes over the objects per repetition of the per-object cases
+const unsigned int OBJECT_PASSES = 1000;
+// Same playfield as the game
+const unsigned int PLAYFIELD_WIDTH = 800;
+const unsigned int PLAYFIELD_HEIGHT = 600;
+
+namespace
+{
+	// A benchmark case: Setup runs untimed before every repetition, Run is timed and returns the operations it did
+	struct BenchmarkCase
+	{
+		std::string Name;
+		std::string Parameters;
+		std::function<void()> Setup;
+		std::function<unsigned long long()> Run;
+	};
+
+	// Keeps the compiler from optimizing away the computation of value
+	template <typename T>
+	inline void keep(const T &value)
+	{
+#if defined(_MSC_VER)
+		static volatile const void *sink;
+		sink = &value;
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	// Counts last level cache misses of the calling thread, where the OS lets us
+	class CacheMissCounter
+	{
+	public:
+		CacheMissCounter() : fd(-1)
+		{
+#if defined(__linux__)
+			perf_event_attr attributes = {};
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.size = sizeof(attributes);
+			attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+			attributes.disabled = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			this->fd = static_cast<int>(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+		}
+		~CacheMissCounter()
+		{
+#if defined(__linux__)
+			if (this->fd >= 0)
+				close(this->fd);
+#endif
+		}
+		CacheMissCounter(const CacheMissCounter &) = delete;
+		CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+		bool Available() const
+		{
+			return this->fd >= 0;
+		}
+		void Start()
+		{
+#if defined(__linux__)
+			if (this->fd >= 0)
+			{
+				ioctl(this->fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(this->fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+		// Misses since Start
+		unsigned long long Stop()
+		{
+			unsigned long long count = 0;
+#if defined(__linux__)
+			if (this->fd >= 0)
+			{
+				ioctl(this->fd, PERF_EVENT_IOC_DISABLE, 0);
+				if (read(this->fd, &count, sizeof(count)) != sizeof(count))
+					count = 0;
+			}
+#endif
+			return count;
+		}
+	private:
+		int fd;
+	};
+
+	// Repeats a case for at least minTime seconds and keeps its fastest repetition
+	BenchmarkResult measure(const BenchmarkCase &benchmark, double minTime, CacheMissCounter &counter)
+	{
+		BenchmarkResult result = { benchmark.Name, benchmark.Parameters, 0, 0.0, 0.0, -1.0 };
+		double total = 0.0;
+		for (unsigned int repetition = 0; repetition < MIN_REPETITIONS || total < minTime * 1e9; ++repetition)
+		{
+			if (benchmark.Setup)
+				benchmark.Setup();
+			unsigned long long allocations = AllocationCounter::Count();
+			counter.Start();
+			auto start = std::chrono::steady_clock::now();
+			unsigned long long operations = benchmark.Run();
+			double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start).count());
+			unsigned long long misses = counter.Stop();
+			allocations = AllocationCounter::Count() - allocations;
+			total += ns;
+			if (operations == 0)
+				continue;
+			double nsPerOp = ns / operations;
+			if (result.Operations == 0 || nsPerOp < result.NsPerOp)
+			{
+				result.Operations = operations;
+				result.NsPerOp = nsPerOp;
+				result.AllocationsPerOp = static_cast<double>(allocations) / operations;
+				result.CacheMissesPerOp = counter.Available() ? static_cast<double>(misses) / operations : -1.0;
+			}
+		}
+		return result;
+	}
+
+	// Writes a width x height level of random tile codes, five in six of them bricks
+	std::string writeLevel(unsigned int width, unsigned int height, Random &random)
+	{
+		std::string file = (std::filesystem::temp_directory_path() /
+			("BrickBreakerBench" + std::to_string(width) + "x" + std::to_string(height) + ".lvl")).string();
+		std::ofstream out(file, std::ios::binary);
+		std::string line;
+		for (unsigned int y = 0; y < height; ++y)
+		{
+			line.clear();
+			for (unsigned int x = 0; x < width; ++x)
+			{
+				line += static_cast<char>('0' + random.Next() % 6);
+				line += x + 1 < width ? ' ' : '\n';
+			}
+			out << line;
+		}
+		return file;
+	}
+
+	// Prints a contact that isn't the expected one; returns whether they match
+	bool sameContact(const char *what, const Contact &contact, const Contact &expected)
+	{
+		if (contact.Hit == expected.Hit && contact.Normal == expected.Normal && contact.Penetration == expected.Penetration)
+			return true;
+		std::printf("MISMATCH: %s: hit %d normal (%g, %g) penetration %g, expected hit %d normal (%g, %g) penetration %g\n", what,
+			contact.Hit, contact.Normal.x, contact.Normal.y, contact.Penetration,
+			expected.Hit, expected.Normal.x, expected.Normal.y, expected.Penetration);
+		return false;
+	}
+
+	// Checks the contact tests against known answers, and the batched test against the one box at a
+	// time one for every center and box given; returns the number of mismatches
+	int checkContacts(const std::vector<BallObject> &balls, const std::vector<glm::vec2> &boxMins, glm::vec2 boxSize)
+	{
+		int mismatches = 0;
+		if (VectorDirection(glm::vec2(0.0f)) != UP)
+		{
+			std::printf("MISMATCH: VectorDirection of the zero vector isn't UP\n");
+			++mismatches;
+		}
+		// A 40x20 box at the origin and a circle of radius 5
+		const glm::vec2 boxMin(0.0f), boxMax(40.0f, 20.0f);
+		const struct
+		{
+			const char *What;
+			glm::vec2 Center;
+			Contact Expected;
+		} known[] = {
+			{ "inside, near the left face", glm::vec2(2.0f, 10.0f), { true, glm::vec2(-1.0f, 0.0f), 7.0f } },
+			{ "inside, at the center", glm::vec2(20.0f, 10.0f), { true, glm::vec2(0.0f, 1.0f), 15.0f } },
+			{ "center on the top face", glm::vec2(20.0f, 0.0f), { true, glm::vec2(0.0f, -1.0f), 5.0f } },
+			{ "outside, right of the box", glm::vec2(43.0f, 10.0f), { true, glm::vec2(1.0f, 0.0f), 2.0f } },
+			{ "outside, off a corner", glm::vec2(44.0f, 24.0f), { false, glm::vec2(0.0f), 0.0f } },
+		};
+		for (const auto &test : known)
+			mismatches += !sameContact(test.What, CircleAABBContact(test.Center, 5.0f, boxMin, boxMax), test.Expected);
+		// One box short of a multiple of the batch width, so the remainder loop runs as well
+		unsigned int count = static_cast<unsigned int>(boxMins.size()) - 1;
+		std::vector<Contact> contacts(count);
+		for (const BallObject &ball : balls)
+		{
+			unsigned int hits = CircleAABBContacts(ball.Position, 12.5f, boxMins.data(), boxSize, count, contacts.data());
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				Contact expected = CircleAABBContact(ball.Position, 12.5f, boxMins[i], boxMins[i] + boxSize);
+				mismatches += !sameContact("CircleAABBContacts", contacts[i], expected);
+				hits -= expected.Hit;
+			}
+			if (hits != 0)
+			{
+				std::printf("MISMATCH: CircleAABBContacts miscounts its hits\n");
+				++mismatches;
+			}
+		}
+		return mismatches;
+	}
+
+	// Writes the results one per line, so a baseline can be read back without a JSON parser
+	bool writeJson(const std::vector<BenchmarkResult> &results, std::ostream &out)
+	{
+		out << "{\n\"benchmarks\": [\n";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const BenchmarkResult &result = results[i];
+			char numbers[256];
+			if (result.CacheMissesPerOp < 0.0)
+				std::snprintf(numbers, sizeof(numbers), "\"operations\": %llu, \"ns_per_op\": %.4f, \"allocs_per_op\": %.6f, \"cache_misses_per_op\": null",
+					result.Operations, result.NsPerOp, result.AllocationsPerOp);
+			else
+				std::snprintf(numbers, sizeof(numbers), "\"operations\": %llu, \"ns_per_op\": %.4f, \"allocs_per_op\": %.6f, \"cache_misses_per_op\": %.6f",
+					result.Operations, result.NsPerOp, result.AllocationsPerOp, result.CacheMissesPerOp);
+			out << "{\"name\": \"" << result.Name << "\", \"parameters\": \"" << result.Parameters << "\", " << numbers << "}"
+				<< (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		out << "]\n}\n";
+		return static_cast<bool>(out);
+	}
+
+	// Value of a string field on a line written by writeJson
+	std::string stringField(const std::string &line, const char *key)
+	{
+		std::string pattern = std::string("\"") + key + "\": \"";
+		size_t start = line.find(pattern);
+		if (start == std::string::npos)
+			return std::string();
+		start += pattern.size();
+		return line.substr(start, line.find('"', start) - start);
+	}
+
+	// Value of a number field on a line written by writeJson, or -1 if it is missing or null
+	double numberField(const std::string &line, const char *key)
+	{
+		std::string pattern = std::string("\"") + key + "\": ";
+		size_t start = line.find(pattern);
+		if (start == std::string::npos)
+			return -1.0;
+		const char *text = line.c_str() + start + pattern.size();
+		char *end;
+		double value = std::strtod(text, &end);
+		return end == text ? -1.0 : value;
+	}
+
+	// Prints every case that got slower or allocates more than in the baseline; returns their number, -1 if the baseline can't be read
+	int compare(const std::vector<BenchmarkResult> &results, const std::string &baseline, double tolerance)
+	{
+		std::ifstream in(baseline);
+		if (!in)
+			return -1;
+		int regressions = 0;
+		std::string line;
+		while (std::getline(in, line))
+		{
+			std::string name = stringField(line, "name");
+			if (name.empty())
+				continue;
+			std::string parameters = stringField(line, "parameters");
+			for (const BenchmarkResult &result : results)
+			{
+				if (result.Name != name || result.Parameters != parameters)
+					continue;
+				double ns = numberField(line, "ns_per_op");
+				double allocations = numberField(line, "allocs_per_op");
+				if (ns > 0.0 && result.NsPerOp > ns * (1.0 + tolerance / 100.0))
+				{
+					std::printf("REGRESSION: %s %s: %.2f ns/op, baseline %.2f (+%.0f%%)\n", name.c_str(), parameters.c_str(),
+						result.NsPerOp, ns, (result.NsPerOp / ns - 1.0) * 100.0);
+					++regressions;
+				}
+				if (allocations >= 0.0 && result.AllocationsPerOp > allocations + 1e-9)
+				{
+					std::printf("REGRESSION: %s %s: %.4f allocs/op, baseline %.4f\n", name.c_str(), parameters.c_str(),
+						result.AllocationsPerOp, allocations);
+					++regressions;
+				}
+			}
+		}
+		return regressions;
+	}
+}
+
+int RunBenchmarks(int argc, char* argv[])
+{
+	std::string filter;
+	double minTime = 0.2;
+	const char *jsonFile = nullptr;
+	const char *baseline = nullptr;
+	double tolerance = 10.0;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc)
+			filter = argv[++i];
+		else if (arg == "--min-time" && i + 1 < argc)
+			minTime = std::atof(argv[++i]);
+		else if (arg == "--json" && i + 1 < argc)
+			jsonFile = argv[++i];
+		else if (arg == "--baseline" && i + 1 < argc)
+			baseline = argv[++i];
+		else if (arg == "--tolerance" && i + 1 < argc)
+			tolerance = std::atof(argv[++i]);
+	}
+
+	// All inputs come from a fixed seed, so every run measures the same work
+	Random random(1);
+	std::vector<BenchmarkCase> cases;
+
+	// Collision tests and ball movement over a set of objects that stays in cache
+	std::vector<GameObject> boxes(OBJECT_COUNT), others(OBJECT_COUNT);
+	std::vector<BallObject> balls(OBJECT_COUNT), movingBalls(OBJECT_COUNT);
+	std::vector<glm::vec2> directions(OBJECT_COUNT);
+	for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+	{
+		// Scattered over a small area, so about half of the pairs touch
+		boxes[i].Position = glm::vec2(random.Range(0.0f, 100.0f), random.Range(0.0f, 100.0f));
+		boxes[i].Size = glm::vec2(random.Range(20.0f, 60.0f), 20.0f);
+		others[i].Position = glm::vec2(random.Range(0.0f, 100.0f), random.Range(0.0f, 100.0f));
+		others[i].Size = glm::vec2(random.Range(20.0f, 60.0f), 20.0f);
+		balls[i].Position = glm::vec2(random.Range(0.0f, 100.0f), random.Range(0.0f, 100.0f));
+		directions[i] = glm::vec2(random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f));
+		if (directions[i] == glm::vec2(0.0f))
+			directions[i].x = 1.0f;
+	}
+	cases.push_back({ "CheckCollision(AABB, AABB)", "objects=" + std::to_string(OBJECT_COUNT), nullptr, [&]() -> unsigned long long
+	{
+		unsigned int hits = 0;
+		for (unsigned int pass = 0; pass < OBJECT_PASSES; ++pass)
+			for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+				hits += CheckCollision(boxes[i], others[(i + pass) % OBJECT_COUNT]);
+		keep(hits);
+		return static_cast<unsigned long long>(OBJECT_PASSES) * OBJECT_COUNT;
+	} });
+	cases.push_back({ "CheckCollision(Circle, AABB)", "objects=" + std::to_string(OBJECT_COUNT), nullptr, [&]() -> unsigned long long
+	{
+		unsigned int hits = 0;
+		for (unsigned int pass = 0; pass < OBJECT_PASSES; ++pass)
+			for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+				hits += std::get<0>(CheckCollision(balls[i], boxes[(i + pass) % OBJECT_COUNT]));
+		keep(hits);
+		return static_cast<unsigned long long>(OBJECT_PASSES) * OBJECT_COUNT;
+	} });
+	cases.push_back({ "VectorDirection", "vectors=" + std::to_string(OBJECT_COUNT), nullptr, [&]() -> unsigned long long
+	{
+		unsigned int sum = 0;
+		for (unsigned int pass = 0; pass < OBJECT_PASSES; ++pass)
+			for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+				sum += VectorDirection(directions[i]);
+		keep(sum);
+		return static_cast<unsigned long long>(OBJECT_PASSES) * OBJECT_COUNT;
+	} });
+	// One circle against a row of brick-sized boxes, one at a time and in SIMD batches
+	std::vector<glm::vec2> boxMins(OBJECT_COUNT);
+	std::vector<Contact> contacts(OBJECT_COUNT);
+	for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+		boxMins[i] = boxes[i].Position;
+	const glm::vec2 boxSize(40.0f, 20.0f);
+	// Timing a wrong answer is no use, so the contact tests are checked first
+	if (int mismatches = checkContacts(balls, boxMins, boxSize))
+	{
+		std::cerr << "ERROR::BENCHMARK: " << mismatches << " wrong circle - box contacts" << std::endl;
+		return -1;
+	}
+	cases.push_back({ "CircleAABBContact", "boxes=" + std::to_string(OBJECT_COUNT), nullptr, [&]() -> unsigned long long
+	{
+		unsigned int hits = 0;
+		for (unsigned int pass = 0; pass < OBJECT_PASSES; ++pass)
+		{
+			glm::vec2 center = balls[pass % OBJECT_COUNT].Position;
+			for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+			{
+				contacts[i] = CircleAABBContact(center, 12.5f, boxMins[i], boxMins[i] + boxSize);
+				hits += contacts[i].Hit;
+			}
+		}
+		keep(hits);
+		return static_cast<unsigned long long>(OBJECT_PASSES) * OBJECT_COUNT;
+	} });
+	cases.push_back({ "CircleAABBContacts", "boxes=" + std::to_string(OBJECT_COUNT), nullptr, [&]() -> unsigned long long
+	{
+		unsigned int hits = 0;
+		for (unsigned int pass = 0; pass < OBJECT_PASSES; ++pass)
+			hits += CircleAABBContacts(balls[pass % OBJECT_COUNT].Position, 12.5f, boxMins.data(), boxSize, OBJECT_COUNT, contacts.data());
+		keep(hits);
+		return static_cast<unsigned long long>(OBJECT_PASSES) * OBJECT_COUNT;
+	} });
+	cases.push_back({ "BallObject::Move", "balls=" + std::to_string(OBJECT_COUNT), [&]()
+	{
+		Random serve(2);
+		for (BallObject &ball : movingBalls)
+		{
+			ball.Position = glm::vec2(serve.Range(0.0f, PLAYFIELD_WIDTH - 25.0f), serve.Range(0.0f, PLAYFIELD_HEIGHT));
+			ball.Velocity = glm::vec2(serve.Range(-300.0f, 300.0f), serve.Range(-300.0f, 300.0f));
+			ball.Stuck = false;
+		}
+	}, [&]() -> unsigned long long
+	{
+		for (unsigned int pass = 0; pass < OBJECT_PASSES; ++pass)
+			for (BallObject &ball : movingBalls)
+				ball.Move(1.0f / 120.0f, PLAYFIELD_WIDTH);
+		keep(movingBalls[0].Position);
+		return static_cast<unsigned long long>(OBJECT_PASSES) * OBJECT_COUNT;
+	} });
+
+	// ParticleGenerator::Update(dt) is the pool update; the generator itself needs a GL context
+	const unsigned int particleCounts[] = { 1000, 100000, 1000000 };
+	std::vector<std::unique_ptr<ParticlePool>> pools;
+	for (unsigned int count : particleCounts)
+	{
+		pools.push_back(std::make_unique<ParticlePool>(count));
+		ParticlePool &pool = *pools.back();
+		cases.push_back({ "ParticlePool::Update", "particles=" + std::to_string(count), [&pool, count]()
+		{
+			Random spawn(3);
+			unsigned int first;
+			pool.Count = 0;
+			pool.Allocate(count, first);
+			for (unsigned int i = 0; i < count; ++i)
+			{
+				pool.PositionX[i] = spawn.Range(0.0f, PLAYFIELD_WIDTH);
+				pool.PositionY[i] = spawn.Range(0.0f, PLAYFIELD_HEIGHT);
+				pool.VelocityX[i] = spawn.Range(-50.0f, 50.0f);
+				pool.VelocityY[i] = spawn.Range(-50.0f, 50.0f);
+				pool.ColorR[i] = pool.ColorG[i] = pool.ColorB[i] = spawn.Range(0.5f, 1.5f);
+				pool.ColorA[i] = 1.0f;
+				pool.Life[i] = spawn.NextFloat();
+			}
+		}, [&pool]() -> unsigned long long
+		{
+			// Lives are in [0, 1], so about a tenth of the particles die over the steps
+			unsigned long long updated = 0;
+			for (unsigned int step = 0; step < 100; ++step)
+			{
+				updated += pool.Count;
+				pool.Update(0.001f);
+			}
+			return updated;
+		} });
+	}
+
+	// Level loading across generated sizes, from the shipped levels' size up
+	const unsigned int levelSizes[][2] = { { 15, 8 }, { 150, 80 }, { 1500, 800 } };
+	std::vector<std::string> levelFiles;
+	std::vector<std::unique_ptr<LevelTiles>> levelTiles;
+	std::vector<std::unique_ptr<GameLevel>> levels;
+	BallSystem sweepBalls(12.5f);
+	GameObject sweepPlayer(glm::vec2(PLAYFIELD_WIDTH / 2.0f - 50.0f, PLAYFIELD_HEIGHT - 20.0f), glm::vec2(100.0f, 20.0f), TextureHandle());
+	std::vector<BrickHit> sweepHits;
+	std::vector<unsigned int> sweepCandidates;
+	for (const unsigned int *size : levelSizes)
+	{
+		std::string parameters = "tiles=" + std::to_string(size[0]) + "x" + std::to_string(size[1]);
+		levelFiles.push_back(writeLevel(size[0], size[1], random));
+		// By value: the next size's push_back can move the strings
+		std::string file = levelFiles.back();
+		levelTiles.push_back(std::make_unique<LevelTiles>());
+		LevelTiles &tiles = *levelTiles.back();
+		GameLevel::ReadTiles(file.c_str(), tiles.Tiles, tiles.Width, tiles.Height);
+		levels.push_back(std::make_unique<GameLevel>());
+		GameLevel &level = *levels.back();
+		// Small levels are loaded many times per repetition, so the timer's resolution doesn't matter
+		unsigned int loads = std::max(1u, 1000000u / (size[0] * size[1]));
+		cases.push_back({ "GameLevel::Load(file)", parameters, nullptr, [&level, file, loads]() -> unsigned long long
+		{
+			for (unsigned int i = 0; i < loads; ++i)
+				level.Load(file.c_str(), 800, 300);
+			return loads;
+		} });
+		// Building the bricks from parsed tiles is all of GameLevel::init
+		cases.push_back({ "GameLevel::Load(tiles)", parameters, nullptr, [&level, &tiles, loads]() -> unsigned long long
+		{
+			for (unsigned int i = 0; i < loads; ++i)
+				level.Load(tiles, 800, 300);
+			return loads;
+		} });
+		cases.push_back({ "GameLevel::IsCompleted", parameters, [&level, &tiles]()
+		{
+			level.Load(tiles, 800, 300);
+		}, [&level]() -> unsigned long long
+		{
+			const unsigned int calls = 1000000;
+			unsigned int completed = 0;
+			for (unsigned int i = 0; i < calls; ++i)
+			{
+				completed += level.IsCompleted();
+				keep(completed);
+			}
+			return calls;
+		} });
+		// The game's resolver: balls spread over the playfield, sweeping a few steps against the bricks
+		cases.push_back({ "BallSystem::Sweep", parameters + " balls=" + std::to_string(OBJECT_COUNT), [&level, &tiles, &sweepBalls]()
+		{
+			level.Load(tiles, PLAYFIELD_WIDTH, PLAYFIELD_HEIGHT / 2);
+			Random serve(3);
+			sweepBalls.Clear();
+			for (unsigned int i = 0; i < OBJECT_COUNT; ++i)
+				sweepBalls.Add(glm::vec2(serve.Range(0.0f, PLAYFIELD_WIDTH - 25.0f), serve.Range(0.0f, PLAYFIELD_HEIGHT - 45.0f)),
+					glm::vec2(serve.Range(-300.0f, 300.0f), serve.Range(-300.0f, 300.0f)), false);
+		}, [&level, &sweepBalls, &sweepPlayer, &sweepHits, &sweepCandidates]() -> unsigned long long
+		{
+			const unsigned int steps = 10;
+			for (unsigned int step = 0; step < steps; ++step)
+			{
+				sweepHits.clear();
+				sweepBalls.Sweep(0, sweepBalls.Count, 1.0f / 120.0f, level, sweepPlayer, static_cast<float>(PLAYFIELD_WIDTH), sweepHits, sweepCandidates);
+			}
+			keep(sweepBalls.PositionX[0]);
+			return static_cast<unsigned long long>(steps) * sweepBalls.Count;
+		} });
+	}
+
+	CacheMissCounter counter;
+	if (!counter.Available())
+		std::cout << "Cache miss counters unavailable (perf_event_open), reporting time and allocations only" << std::endl;
+	std::vector<BenchmarkResult> results;
+	for (const BenchmarkCase &benchmark : cases)
+	{
+		if (!filter.empty() && benchmark.Name.find(filter) == std::string::npos)
+			continue;
+		results.push_back(measure(benchmark, minTime, counter));
+		const BenchmarkResult &result = results.back();
+		std::printf("%-28s %-18s %12.2f ns/op %10.4f allocs/op", result.Name.c_str(), result.Parameters.c_str(),
+			result.NsPerOp, result.AllocationsPerOp);
+		if (result.CacheMissesPerOp >= 0.0)
+			std::printf(" %10.4f misses/op", result.CacheMissesPerOp);
+		std::printf("\n");
+	}
+	for (const std::string &file : levelFiles)
+		std::remove(file.c_str());
+
+	if (jsonFile)
+	{
+		bool written;
+		if (std::string(jsonFile) == "-")
+			written = writeJson(results, std::cout);
+		else
+		{
+			std::ofstream out(jsonFile, std::ios::trunc);
+			written = out && writeJson(results, out);
+		}
+		if (!written)
+		{
+			std::cerr << "ERROR::BENCHMARK: Can't write " << jsonFile << std::endl;
+			return -1;
+		}
+	}
+	if (baseline)
+	{
+		int regressions = compare(results, baseline, tolerance);
+		if (regressions < 0)
+		{
+			std::cerr << "ERROR::BENCHMARK: Can't read baseline " << baseline << std::endl;
+			return -1;
+		}
+		std::cout << regressions << " regressions against " << baseline << std::endl;
+		return regressions > 0 ? 1 : 0;
+	}
+	return 0;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+// One measured benchmark case
+struct BenchmarkResult
+{
+	std::string Name;       // What was measured, e.g. "VectorDirection"
+	std::string Parameters; // Size it was measured at, e.g. "particles=100000"
+	unsigned long long Operations; // Operations in the fastest repetition
+	double NsPerOp;
+	double AllocationsPerOp;
+	double CacheMissesPerOp; // Negative if hardware counters aren't available
+};
+
+// Runs the benchmark suite for the simulation's hot paths: the collision
+// tests, ball movement, the particle update and level loading, at several
+// generated level sizes and particle counts. Every case is repeated for at
+// least --min-time seconds and reported with its fastest repetition: time,
+// heap allocations and, where perf_event_open is available, last level
+// cache misses per operation. Options:
+//   --filter S      only runs cases whose name contains S
+//   --min-time S    seconds to repeat each case for (default 0.2)
+//   --json F        writes the results to F as JSON, "-" for stdout
+//   --baseline F    compares against the JSON of an earlier run and fails
+//                   if a case got slower or allocates more
+//   --tolerance P   percent a case may get slower before it counts as a
+//                   regression (default 10)
+int RunBenchmarks(int argc, char* argv[]);
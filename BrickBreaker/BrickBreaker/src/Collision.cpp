@@ -0,0 +1,240 @@
+#include "Collision.h"
+
+#include <utility>
+
+// SSE2 covers the batch test; MSVC implies it on x64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLLISION_SSE
+
+namespace
+{
+	// Lanes of a where mask is set, else of b
+	inline __m128 selectLanes(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	// Contacts of circles with boxes, one pair per lane; Hit is a lane mask
+	struct ContactLanes
+	{
+		__m128 Hit, NormalX, NormalY, Penetration;
+	};
+
+	// The circle - box contact of CircleAABBContact, computed without a single branch
+	inline ContactLanes contactLanes(__m128 cx, __m128 cy, __m128 radius, __m128 minX, __m128 minY, __m128 maxX, __m128 maxY)
+	{
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f), minusOne = _mm_set1_ps(-1.0f);
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		__m128 toMinX = _mm_sub_ps(cx, minX), toMinY = _mm_sub_ps(cy, minY);
+		__m128 toMaxX = _mm_sub_ps(maxX, cx), toMaxY = _mm_sub_ps(maxY, cy);
+		__m128 depthX = _mm_min_ps(toMinX, toMaxX), depthY = _mm_min_ps(toMinY, toMaxY);
+		__m128 outsideX = _mm_max_ps(_mm_xor_ps(depthX, signBit), zero), outsideY = _mm_max_ps(_mm_xor_ps(depthY, signBit), zero);
+		ContactLanes contact;
+		contact.Hit = _mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(outsideX, outsideX), _mm_mul_ps(outsideY, outsideY)), _mm_mul_ps(radius, radius));
+		__m128 alongX = _mm_cmplt_ps(depthX, depthY);
+		__m128 signX = selectLanes(_mm_cmplt_ps(toMinX, toMaxX), minusOne, one), signY = selectLanes(_mm_cmplt_ps(toMinY, toMaxY), minusOne, one);
+		contact.NormalX = _mm_and_ps(contact.Hit, _mm_and_ps(alongX, signX));
+		contact.NormalY = _mm_and_ps(contact.Hit, _mm_andnot_ps(alongX, signY));
+		contact.Penetration = _mm_and_ps(contact.Hit, _mm_add_ps(radius, selectLanes(alongX, depthX, depthY)));
+		return contact;
+	}
+}
+#endif
+
+bool CheckCollision(GameObject& one, GameObject& two) // AABB - AABB collision
+{
+	// collision x-axis?
+	bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
+		two.Position.x + two.Size.x >= one.Position.x;
+	// collision y-axis?
+	bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
+		two.Position.y + two.Size.y >= one.Position.y;
+	// collision only if on both axes
+	return collisionX && collisionY;
+}
+
+Collision CheckCollision(BallObject& one, GameObject& two) // AABB - Circle collision
+{
+	// get center point circle first
+	glm::vec2 center(one.Position + one.Radius);
+	// the point of the box closest to the circle's center
+	glm::vec2 closest = glm::clamp(center, two.Position, two.Position + two.Size);
+	// retrieve vector between center circle and closest point AABB and check if it is shorter than the radius, squared to save the root
+	glm::vec2 difference = closest - center;
+	if (glm::dot(difference, difference) < one.Radius * one.Radius)
+		return std::make_tuple(true, VectorDirection(difference), difference);
+	else
+		return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
+}
+
+Direction VectorDirection(glm::vec2 target)
+{
+	// The compass direction closest to target lies along its longer axis. On a tie both
+	// directions are as close and the one listed first in Direction wins: UP and DOWN beat
+	// the horizontal ones, except RIGHT before DOWN; the zero vector ties everywhere, UP.
+	glm::vec2 size = glm::abs(target);
+	bool vertical = size.y > size.x || (size.y == size.x && !(target.x > 0.0f && target.y < 0.0f));
+	return vertical ? (target.y < 0.0f ? DOWN : UP) : (target.x > 0.0f ? RIGHT : LEFT);
+}
+
+Contact CircleAABBContact(glm::vec2 center, float radius, glm::vec2 boxMin, glm::vec2 boxMax)
+{
+	// How far the center is inside the box from the nearer face of each axis is negative on
+	// an axis the center is outside on, by how far it is out. The least deep axis is the one
+	// the center is furthest out on, or, inside the box, the one with the nearest face.
+	Contact contact;
+#if defined(COLLISION_SSE)
+	// Compilers turn the float selects below into branches, so take one SIMD lane instead
+	ContactLanes lanes = contactLanes(_mm_set_ss(center.x), _mm_set_ss(center.y), _mm_set_ss(radius),
+		_mm_set_ss(boxMin.x), _mm_set_ss(boxMin.y), _mm_set_ss(boxMax.x), _mm_set_ss(boxMax.y));
+	contact.Hit = _mm_movemask_ps(lanes.Hit) & 1;
+	contact.Normal = glm::vec2(_mm_cvtss_f32(lanes.NormalX), _mm_cvtss_f32(lanes.NormalY));
+	contact.Penetration = _mm_cvtss_f32(lanes.Penetration);
+#else
+	glm::vec2 toMin = center - boxMin;
+	glm::vec2 toMax = boxMax - center;
+	glm::vec2 depth = glm::min(toMin, toMax);
+	glm::vec2 outside = glm::max(-depth, glm::vec2(0.0f));
+	bool hit = glm::dot(outside, outside) < radius * radius;
+	bool alongX = depth.x < depth.y;
+	glm::vec2 sign(toMin.x < toMax.x ? -1.0f : 1.0f, toMin.y < toMax.y ? -1.0f : 1.0f);
+	contact.Hit = hit;
+	contact.Normal = hit ? (alongX ? glm::vec2(sign.x, 0.0f) : glm::vec2(0.0f, sign.y)) : glm::vec2(0.0f);
+	contact.Penetration = hit ? radius + (alongX ? depth.x : depth.y) : 0.0f;
+#endif
+	return contact;
+}
+
+unsigned int CircleAABBContacts(glm::vec2 center, float radius, const glm::vec2 *boxMins, glm::vec2 boxSize, unsigned int count, Contact *contacts)
+{
+	unsigned int hits = 0;
+	unsigned int i = 0;
+#if defined(COLLISION_SSE)
+	const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), vradius = _mm_set1_ps(radius);
+	const __m128 width = _mm_set1_ps(boxSize.x), height = _mm_set1_ps(boxSize.y);
+	const float *boxes = reinterpret_cast<const float *>(boxMins);
+	for (; i + 4 <= count; i += 4)
+	{
+		// Deinterleave four (x, y) minimums
+		__m128 low = _mm_loadu_ps(boxes + i * 2), high = _mm_loadu_ps(boxes + i * 2 + 4);
+		__m128 minX = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 minY = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+		ContactLanes lanes = contactLanes(cx, cy, vradius, minX, minY, _mm_add_ps(minX, width), _mm_add_ps(minY, height));
+		alignas(16) float normalX[4], normalY[4], penetration[4];
+		_mm_store_ps(normalX, lanes.NormalX);
+		_mm_store_ps(normalY, lanes.NormalY);
+		_mm_store_ps(penetration, lanes.Penetration);
+		int mask = _mm_movemask_ps(lanes.Hit);
+		for (unsigned int lane = 0; lane < 4; ++lane)
+		{
+			Contact &contact = contacts[i + lane];
+			contact.Hit = (mask >> lane) & 1;
+			contact.Normal = glm::vec2(normalX[lane], normalY[lane]);
+			contact.Penetration = penetration[lane];
+			hits += contact.Hit;
+		}
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		contacts[i] = CircleAABBContact(center, radius, boxMins[i], boxMins[i] + boxSize);
+		hits += contacts[i].Hit;
+	}
+	return hits;
+}
+
+SweepHit SweepCircleAABB(glm::vec2 center, float radius, glm::vec2 motion, glm::vec2 boxMin, glm::vec2 boxMax)
+{
+	SweepHit result = { false, 1.0f, glm::vec2(0.0f), 0.0f };
+	// Already overlapping: report a contact right away, unless the circle is on its way out
+	glm::vec2 closest = glm::clamp(center, boxMin, boxMax);
+	glm::vec2 difference = center - closest;
+	float distanceSquared = glm::dot(difference, difference);
+	if (distanceSquared < radius * radius)
+	{
+		glm::vec2 normal;
+		float penetration;
+		if (distanceSquared > 0.0f)
+		{
+			float distance = glm::sqrt(distanceSquared);
+			normal = difference / distance;
+			penetration = radius - distance;
+		}
+		else
+		{
+			// Center is inside the box: leave through the nearest face
+			glm::vec2 toMin = center - boxMin;
+			glm::vec2 toMax = boxMax - center;
+			glm::vec2 nearest = glm::min(toMin, toMax);
+			if (nearest.x < nearest.y)
+				normal = glm::vec2(toMin.x < toMax.x ? -1.0f : 1.0f, 0.0f);
+			else
+				normal = glm::vec2(0.0f, toMin.y < toMax.y ? -1.0f : 1.0f);
+			penetration = glm::min(nearest.x, nearest.y) + radius;
+		}
+		if (glm::dot(motion, normal) >= 0.0f)
+			return result;
+		result.Hit = true;
+		result.Time = 0.0f;
+		result.Normal = normal;
+		result.Penetration = penetration;
+		return result;
+	}
+
+	// Ray (the circle's center) against the box grown by the radius, one slab per axis
+	glm::vec2 expandedMin = boxMin - radius;
+	glm::vec2 expandedMax = boxMax + radius;
+	float enter = -1.0f, exit = 2.0f;
+	int enterAxis = 0;
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		if (motion[axis] == 0.0f)
+		{
+			if (center[axis] < expandedMin[axis] || center[axis] > expandedMax[axis])
+				return result;
+			continue;
+		}
+		float t1 = (expandedMin[axis] - center[axis]) / motion[axis];
+		float t2 = (expandedMax[axis] - center[axis]) / motion[axis];
+		if (t1 > t2)
+			std::swap(t1, t2);
+		if (t1 > enter)
+		{
+			enter = t1;
+			enterAxis = axis;
+		}
+		exit = glm::min(exit, t2);
+	}
+	if (enter > exit || enter > 1.0f || exit < 0.0f)
+		return result;
+
+	// The grown box has rounded corners: if the ray enters next to a corner, test that corner's circle instead
+	glm::vec2 point = center + motion * glm::max(enter, 0.0f);
+	bool outsideX = point.x < boxMin.x || point.x > boxMax.x;
+	bool outsideY = point.y < boxMin.y || point.y > boxMax.y;
+	if (outsideX && outsideY)
+	{
+		glm::vec2 corner(point.x < boxMin.x ? boxMin.x : boxMax.x, point.y < boxMin.y ? boxMin.y : boxMax.y);
+		glm::vec2 m = center - corner;
+		float a = glm::dot(motion, motion);
+		float b = glm::dot(m, motion);
+		float c = glm::dot(m, m) - radius * radius;
+		float discriminant = b * b - a * c;
+		if (discriminant < 0.0f)
+			return result;
+		float t = (-b - glm::sqrt(discriminant)) / a;
+		if (t < 0.0f || t > 1.0f)
+			return result;
+		result.Hit = true;
+		result.Time = t;
+		result.Normal = glm::normalize(center + motion * t - corner);
+		return result;
+	}
+	if (enter < 0.0f)
+		return result;
+	result.Hit = true;
+	result.Time = enter;
+	result.Normal[enterAxis] = motion[enterAxis] > 0.0f ? -1.0f : 1.0f;
+	return result;
+}
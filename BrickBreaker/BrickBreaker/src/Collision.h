@@ -0,0 +1,54 @@
+#pragma once
+
+#include <tuple>
+
+#include <glm/glm.hpp>
+
+#include "GameObject.h"
+#include "BallObject.h"
+
+// Four collision directions
+enum Direction {
+	UP,
+	RIGHT,
+	DOWN,
+	LEFT
+};
+
+// Defines a collision typedef that represents collision data
+typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?>, what direction?, difference vector center - closest point>
+
+// First contact of a moving circle with a shape
+struct SweepHit
+{
+	bool Hit;
+	float Time;        // Fraction [0, 1] of the motion after which the circle touches the shape
+	glm::vec2 Normal;  // Contact normal, pointing from the shape towards the circle
+	float Penetration; // How deep the circle already overlaps the shape at the start (0 if it doesn't)
+};
+
+// Overlap of a circle with a box
+struct Contact
+{
+	bool Hit;
+	glm::vec2 Normal;  // Normal of the box face the circle is pushed out through, pointing towards the circle
+	float Penetration; // How far the circle has to move along Normal to get out of the box (0 if it isn't in it)
+};
+
+// AABB - AABB collision
+bool CheckCollision(GameObject& one, GameObject& two);
+// AABB - Circle collision
+Collision CheckCollision(BallObject& one, GameObject& two);
+// Returns the compass direction closest to the given vector; UP for the zero vector
+Direction VectorDirection(glm::vec2 target);
+// Tests a circle against the box [boxMin, boxMax] without square roots or branches. The
+// contact is resolved along the axis the circle's center is furthest out on, or, if the
+// center is inside the box, through the nearest face.
+Contact CircleAABBContact(glm::vec2 center, float radius, glm::vec2 boxMin, glm::vec2 boxMax);
+// Tests a circle against count boxes of the same size, e.g. a level's bricks, several boxes
+// per SIMD instruction; writes one contact per box, the same CircleAABBContact gives, and
+// returns the number of hits
+unsigned int CircleAABBContacts(glm::vec2 center, float radius, const glm::vec2 *boxMins, glm::vec2 boxSize, unsigned int count, Contact *contacts);
+// Sweeps a circle along motion and returns its first contact with the box [boxMin, boxMax].
+// A circle that already overlaps the box while moving into it is reported as a hit at time 0.
+SweepHit SweepCircleAABB(glm::vec2 center, float radius, glm::vec2 motion, glm::vec2 boxMin, glm::vec2 boxMax);
\ No newline at end of file
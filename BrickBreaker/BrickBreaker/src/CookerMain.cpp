@@ -0,0 +1,7 @@
+#include "AssetCooker.h"
+
+// Entry point of the asset cooker
+int main(int argc, char* argv[])
+{
+	return CookAssets(argc, argv);
+}
\ No newline at end of file
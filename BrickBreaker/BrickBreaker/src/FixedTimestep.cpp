@@ -0,0 +1,27 @@
+#include "FixedTimestep.h"
+
+FixedTimestep::FixedTimestep(float rate /*= 120.0f*/, unsigned int maxSteps /*= 8*/)
+	: Step(1.0f / rate), MaxSteps(maxSteps), accumulator(0.0f)
+{
+
+}
+
+unsigned int FixedTimestep::Advance(float frameTime)
+{
+	this->accumulator += frameTime;
+	unsigned int steps = 0;
+	while (this->accumulator >= this->Step && steps < this->MaxSteps)
+	{
+		this->accumulator -= this->Step;
+		++steps;
+	}
+	// Catch-up cap reached: drop the backlog instead of carrying it into the next frame
+	if (this->accumulator >= this->Step)
+		this->accumulator = 0.0f;
+	return steps;
+}
+
+float FixedTimestep::Alpha() const
+{
+	return this->accumulator / this->Step;
+}
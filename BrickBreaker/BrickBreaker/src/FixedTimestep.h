@@ -0,0 +1,23 @@
+#pragma once
+
+// FixedTimestep decouples the simulation rate from the frame rate. Every
+// frame adds its real duration to an accumulator, which is then drained in
+// whole simulation steps; the leftover fraction of a step is used to blend
+// the rendered state between the last two simulated states.
+class FixedTimestep
+{
+public:
+	// Length of one simulation step in seconds
+	float Step;
+	// Maximum number of steps run per frame; time beyond that is dropped so a
+	// long stall doesn't snowball into ever longer catch-up frames
+	unsigned int MaxSteps;
+
+	FixedTimestep(float rate = 120.0f, unsigned int maxSteps = 8);
+	// Adds the duration of a frame and returns how many steps to simulate
+	unsigned int Advance(float frameTime);
+	// How far [0, 1) the current time is between the last step and the next
+	float Alpha() const;
+private:
+	float accumulator;
+};
\ No newline at end of file
@@ -1,18 +1,37 @@
 #include "Game.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
 #include "Resource_Manager.h"
 #include "SpriteRenderer.h"
+#include "SpriteBatch.h"
 #include "GameObject.h"
-#include "BallObject.h"
 #include "ParticleGenerator.h"
+#include "Collision.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
 
 // Game-related save data
 SpriteRenderer *Renderer;
+SpriteBatch *Batch;
 GameObject *Player;
-BallObject* Ball;
+TextureHandle BallSprite;
+TextureHandle BackgroundTexture;
 ParticleGenerator* Particles;
+JobSystem *Jobs;
+// Position at the start of the current step, used to interpolate rendering
+glm::vec2 PlayerPrevious;
+// Bricks returned by the broadphase, one list per worker, reused every frame
+std::vector<std::vector<unsigned int>> BrickCandidates;
+// Bricks reached by balls during the current step, one list per worker and the merged result
+std::vector<std::vector<BrickHit>> WorkerHits;
+std::vector<BrickHit> BallHits;
 
-Game::Game(unsigned int width, unsigned int height)
-	: State(GAME_ACTIVE), Keys(), Width(width), Height(height)
+Game::Game(unsigned int width, unsigned int height, bool headless /*= false*/)
+	: State(GAME_ACTIVE), Keys(), Width(width), Height(height), Balls(BALL_RADIUS), BallCount(1), Threads(0), Seed(1), Headless(headless)
 {
 
 }
@@ -20,123 +39,189 @@ Game::Game(unsigned int width, unsigned int height)
 Game::~Game()
 {
 	delete Renderer;
+	delete Batch;
 	delete Player;
-	delete Ball;
 	delete Particles;
+	delete Jobs;
 }
 
 void Game::Init()
 {
-	// Load shaders
-	ResourceManager::LoadShader("BrickBreaker/res/Shaders/Sprite.vs", "BrickBreaker/res/Shaders/Sprite.frag", nullptr, "sprite");
-	ResourceManager::LoadShader("BrickBreaker/res/Shaders/Particle.vs", "BrickBreaker/res/Shaders/Particle.frag", nullptr, "particle");
-	// Configure shaders
-	glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width),
-		static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
-	ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
-	ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-	ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-	ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
-	// Load textures
-	ResourceManager::LoadTexture("BrickBreaker/res/Textures/background.jpg", false, "background");
-	ResourceManager::LoadTexture("BrickBreaker/res/Textures/awesomeface.png", true, "face");
-	ResourceManager::LoadTexture("BrickBreaker/res/Textures/block.png", false, "block");
-	ResourceManager::LoadTexture("BrickBreaker/res/Textures/block_solid.png", false, "block_solid");
-	ResourceManager::LoadTexture("BrickBreaker/res/Textures/paddle.png", true, "paddle");
-	ResourceManager::LoadTexture("BrickBreaker/res/Textures/particle.png", true, "particle");
-	// Set render specific controls
-	Shader myShader;
-	myShader = ResourceManager::GetShader("sprite");
-	Renderer = new SpriteRenderer(myShader);
-	Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
-	// Load levels
-	GameLevel one; one.Load("BrickBreaker/res/Levels/one.lvl", this->Width, this->Height / 2);
-	GameLevel two; two.Load("BrickBreaker/res/Levels/two.lvl", this->Width, this->Height / 2);
-	GameLevel three; three.Load("BrickBreaker/res/Levels/three.lvl", this->Width, this->Height / 2);
-	GameLevel four; four.Load("BrickBreaker/res/Levels/four.lvl", this->Width, this->Height / 2);
-	this->Levels.push_back(one);
-	this->Levels.push_back(two);
-	this->Levels.push_back(three);
-	this->Levels.push_back(four);
+	// Cooked assets replace the loose files they were made from, when the pack is there
+	ResourceManager::OpenPack("BrickBreaker/res/assets.pack");
+	// Parse the levels in the background while the GL resources are set up
+	unsigned int levelHeight = this->Height / 2;
+	std::future<GameLevel> levelFiles[] = {
+		ResourceManager::LoadLevelAsync("BrickBreaker/res/Levels/one.lvl", this->Width, levelHeight),
+		ResourceManager::LoadLevelAsync("BrickBreaker/res/Levels/two.lvl", this->Width, levelHeight),
+		ResourceManager::LoadLevelAsync("BrickBreaker/res/Levels/three.lvl", this->Width, levelHeight),
+		ResourceManager::LoadLevelAsync("BrickBreaker/res/Levels/four.lvl", this->Width, levelHeight)
+	};
+	// Headless games only simulate, so they skip everything that needs a GL context
+	if (!this->Headless)
+	{
+		// Load shaders
+		ResourceManager::LoadShader("BrickBreaker/res/Shaders/Sprite.vs", "BrickBreaker/res/Shaders/Sprite.frag", nullptr, "sprite");
+		ResourceManager::LoadShader("BrickBreaker/res/Shaders/Particle.vs", "BrickBreaker/res/Shaders/Particle.frag", nullptr, "particle");
+		ResourceManager::LoadShader("BrickBreaker/res/Shaders/SpriteBatch.vs", "BrickBreaker/res/Shaders/SpriteBatch.frag", nullptr, "batch");
+		// Configure shaders
+		glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width),
+			static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
+		ResourceManager::GetShader("sprite").Use().SetInteger("image", 0);
+		ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
+		ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
+		ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+		ResourceManager::GetShader("batch").Use().SetInteger("image", 0);
+		ResourceManager::GetShader("batch").SetMatrix4("projection", projection);
+		// Load textures; the background is decoded in the background and shows a placeholder until then
+		BackgroundTexture = ResourceManager::LoadTextureAsync("BrickBreaker/res/Textures/background.jpg", false, "background");
+		// Sprites share atlas pages so the batch can draw bricks, paddle and balls together
+		ResourceManager::LoadTextureAtlas({
+			{ "face", "BrickBreaker/res/Textures/awesomeface.png", true },
+			{ "block", "BrickBreaker/res/Textures/block.png", false },
+			{ "block_solid", "BrickBreaker/res/Textures/block_solid.png", false },
+			{ "paddle", "BrickBreaker/res/Textures/paddle.png", true },
+			{ "particle", "BrickBreaker/res/Textures/particle.png", true }
+		}, "BrickBreaker/res/Textures/sprites.atlas");
+		// Set render specific controls
+		Shader myShader;
+		myShader = ResourceManager::GetShader("sprite");
+		Renderer = new SpriteRenderer(myShader);
+		Shader batchShader = ResourceManager::GetShader("batch");
+		Batch = new SpriteBatch(batchShader);
+		Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
+		Particles->Seed(this->Seed);
+	}
+	// Collision workers, each with its own scratch buffers
+	Jobs = new JobSystem(this->Threads);
+	BrickCandidates.resize(Jobs->WorkerCount);
+	WorkerHits.resize(Jobs->WorkerCount);
+	// Take the loaded levels over; moving keeps the capacity reserved for their undo logs, copying wouldn't
+	this->Levels.reserve(std::size(levelFiles));
+	for (std::future<GameLevel> &file : levelFiles)
+	{
+		this->Levels.push_back(file.get());
+		// Headless games never draw the bricks
+		if (!this->Headless)
+			this->Levels.back().ResolveSprites();
+	}
 	this->Level = 0;
 	// Configure game objects
 	glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-	Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
-	glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
-	Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+	// Headless games have no textures to look up, so their sprites stay invalid handles
+	Player = new GameObject(playerPos, PLAYER_SIZE, this->Headless ? TextureHandle() : ResourceManager::FindTexture("paddle"));
+	BallSprite = this->Headless ? TextureHandle() : ResourceManager::FindTexture("face");
+	PlayerPrevious = Player->Position;
+	this->SpawnBalls(this->BallCount);
 }
 
 void Game::ProcessInput(float dt)
 {
+	PROFILE_SCOPE("ProcessInput");
 	if (this->State == GAME_ACTIVE)
 	{
 		float velocity = PLAYER_VELOCITY * dt;
+		float moved = 0.0f;
 		// Move playerboard
 		if (this->Keys[GLFW_KEY_A])
 		{
 			if (Player->Position.x >= 0.0f)
-			{
-				Player->Position.x -= velocity;
-				if (Ball->Stuck)
-					Ball->Position.x -= velocity;
-			}
+				moved -= velocity;
 		}
 		if (this->Keys[GLFW_KEY_D])
 		{
 			if (Player->Position.x <= this->Width - Player->Size.x)
-			{
-				Player->Position.x += velocity;
-				if (Ball->Stuck)
-					Ball->Position.x += velocity;
-			}
+				moved += velocity;
+		}
+		Player->Position.x += moved;
+		// Stuck balls ride along with the paddle
+		for (unsigned int i = 0; i < this->Balls.Count; ++i)
+		{
+			if (this->Balls.Stuck[i])
+				this->Balls.PositionX[i] += moved;
 		}
 		if (this->Keys[GLFW_KEY_SPACE])
-			Ball->Stuck = false;
+			std::fill(this->Balls.Stuck.begin(), this->Balls.Stuck.end(), 0);
 	}
 }
 
+void Game::Step(float dt)
+{
+	PlayerPrevious = Player->Position;
+	this->Balls.SavePrevious();
+	this->ProcessInput(dt);
+	this->Update(dt);
+}
+
 void Game::Update(float dt)
 {
 	if (this->State != GAME_ACTIVE) return;
+	PROFILE_SCOPE("Update");
 
-	Ball->Move(dt, this->Width);
-	// Check for collisions
-	this->DoCollisions();
+	// Move the balls and resolve their collisions
+	this->DoCollisions(dt);
 
 	// Update particles
-	Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+	if (Particles)
+	{
+		PROFILE_SCOPE("Particles");
+		unsigned int trails = std::min(this->Balls.Count, MAX_BALL_TRAILS);
+		for (unsigned int i = 0; i < trails; ++i)
+		{
+			glm::vec2 position(this->Balls.PositionX[i], this->Balls.PositionY[i]);
+			glm::vec2 velocity(this->Balls.VelocityX[i], this->Balls.VelocityY[i]);
+			Particles->Spawn(position, velocity, 2, glm::vec2(this->Balls.Radius / 2.0f));
+		}
+		Particles->Update(dt);
+	}
 
-	if (Ball->Position.y >= this->Height) // Did ball reach bottom edge?
+	// Drop the balls that reached the bottom edge; the player loses once all are gone
+	this->Balls.RemoveBelow(static_cast<float>(this->Height));
+	if (this->Balls.Count == 0)
 	{
 		this->ResetLevel();
 		this->ResetPlayer();
 	}
 }
 
-void Game::Render()
+void Game::Render(float alpha /*= 1.0f*/)
 {
-	// Draw background
-	Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
-	// Draw level
-	this->Levels[this->Level].Draw(*Renderer);
-	// Draw player
-	Player->Draw(*Renderer);
-	// Draw particles
-	Particles->Draw();
-	// Draw ball
-	Ball->Draw(*Renderer);
+	if (this->Headless)
+		return;
+	PROFILE_SCOPE("Render");
+	{
+		PROFILE_GPU_SCOPE("GPU Level");
+		// Draw background
+		Renderer->DrawSprite(ResourceManager::GetTexture(BackgroundTexture), glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
+		// Draw level and player in as few draw calls as possible
+		Batch->Begin();
+		this->Levels[this->Level].Draw(*Batch);
+		Batch->Submit(ResourceManager::GetTexture(Player->Sprite), glm::mix(PlayerPrevious, Player->Position, alpha), Player->Size, Player->Rotation, Player->Color);
+		Batch->End();
+	}
+	{
+		PROFILE_GPU_SCOPE("GPU Particles");
+		Particles->Draw();
+	}
+	{
+		PROFILE_GPU_SCOPE("GPU Balls");
+		// Draw balls on top of the particles
+		Batch->Begin();
+		const Texture2D &ballSprite = ResourceManager::GetTexture(BallSprite);
+		glm::vec2 ballSize(this->Balls.Radius * 2.0f);
+		for (unsigned int i = 0; i < this->Balls.Count; ++i)
+		{
+			glm::vec2 previous(this->Balls.PreviousX[i], this->Balls.PreviousY[i]);
+			glm::vec2 position(this->Balls.PositionX[i], this->Balls.PositionY[i]);
+			Batch->Submit(ballSprite, glm::mix(previous, position, alpha), ballSize);
+		}
+		Batch->End();
+	}
 }
 
 void Game::ResetLevel()
 {
-	if (this->Level == 0)
-		this->Levels[0].Load("BrickBreaker/res/Levels/one.lvl", this->Width, this->Height / 2);
-	else if (this->Level == 1)
-		this->Levels[1].Load("BrickBreaker/res/Levels/two.lvl", this->Width, this->Height / 2);
-	else if (this->Level == 2)
-		this->Levels[2].Load("BrickBreaker/res/Levels/three.lvl", this->Width, this->Height / 2);
-	else if (this->Level == 3)
-		this->Levels[3].Load("BrickBreaker/res/Levels/four.lvl", this->Width, this->Height / 2);
+	this->Levels[this->Level].Reset();
 }
 
 void Game::ResetPlayer()
@@ -144,120 +229,86 @@ void Game::ResetPlayer()
 	// reset player/ball stats
 	Player->Size = PLAYER_SIZE;
 	Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-	Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+	this->Balls.Clear();
+	this->SpawnBalls(this->BallCount);
+	// Don't interpolate across the reset
+	PlayerPrevious = Player->Position;
 }
 
-bool CheckCollision(GameObject& one, GameObject& two);
-Collision CheckCollision(BallObject& one, GameObject& two);
-Direction VectorDirection(glm::vec2 closest);
-
-void Game::DoCollisions()
+void Game::SpawnBalls(unsigned int count)
 {
-	for (GameObject& box : this->Levels[this->Level].Bricks)
+	glm::vec2 position = Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f));
+	float speed = glm::length(INITIAL_BALL_VELOCITY);
+	for (unsigned int i = 0; i < count; ++i)
 	{
-		if (!box.Destroyed)
+		// A single ball keeps the classic serve
+		glm::vec2 velocity = INITIAL_BALL_VELOCITY;
+		if (count > 1)
 		{
-			Collision collision = CheckCollision(*Ball, box);
-			if (std::get<0>(collision)) // If collision is true
-			{
-				// Destroy box if not solid
-				if (!box.IsSolid)
-					box.Destroyed = true;
-				// Collision resolution
-				Direction dir = std::get<1>(collision);
-				glm::vec2 diff_vector = std::get<2>(collision);
-				if (dir == LEFT || dir == RIGHT) // Horizontal collision
-				{
-					Ball->Velocity.x = -Ball->Velocity.x; // Reverse horizontal velocity
-					// Relocate
-					float penetration = Ball->Radius - std::abs(diff_vector.x);
-					if (dir == LEFT)
-						Ball->Position.x += penetration; // Move ball right
-					else
-						Ball->Position.x -= penetration; // Move ball left
-				}
-				else // Vertical collision
-				{
-					Ball->Velocity.y = -Ball->Velocity.y; // Reverse vertical velocity
-					// Relocate
-					float penetration = Ball->Radius - std::abs(diff_vector.y);
-					if (dir == UP)
-						Ball->Position.y -= penetration; // Move ball back up
-					else
-						Ball->Position.y += penetration; // Move ball back down
-				}
-			}
+			float angle = glm::radians(BALL_SPREAD) * (2.0f * i / (count - 1) - 1.0f);
+			velocity = speed * glm::vec2(sin(angle), -cos(angle));
 		}
-	}
-	Collision result = CheckCollision(*Ball, *Player);
-	if (!Ball->Stuck && std::get<0>(result))
-	{
-		// Check where it hit the board, and change velocity based on where it hit the board
-		float centerBoard = Player->Position.x + Player->Size.x / 2.0f;
-		float distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-		float percentage = distance / (Player->Size.x / 2.0f);
-		// Then move accordingly
-		float strength = 2.0f;
-		glm::vec2 oldVelocity = Ball->Velocity;
-		Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength;
-		//Ball->Velocity.y = -Ball->Velocity.y;
-		Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity);
-		// Fix sticky paddle
-		Ball->Velocity.y = -1.0f * abs(Ball->Velocity.y);
+		this->Balls.Add(position, velocity, true);
 	}
 }
 
-bool CheckCollision(GameObject& one, GameObject& two) // AABB - AABB collision
+namespace
 {
-	// collision x-axis?
-	bool collisionX = one.Position.x + one.Size.x >= two.Position.x &&
-		two.Position.x + two.Size.x >= one.Position.x;
-	// collision y-axis?
-	bool collisionY = one.Position.y + one.Size.y >= two.Position.y &&
-		two.Position.y + two.Size.y >= one.Position.y;
-	// collision only if on both axes
-	return collisionX && collisionY;
+	// 64-bit FNV-1a over raw bytes, continuing from hash
+	uint64_t hashBytes(uint64_t hash, const void *data, size_t size)
+	{
+		const unsigned char *bytes = static_cast<const unsigned char *>(data);
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		return hash;
+	}
+
+	template <typename T>
+	uint64_t hashArray(uint64_t hash, const std::vector<T> &values, unsigned int count)
+	{
+		return hashBytes(hash, values.data(), count * sizeof(T));
+	}
 }
 
-Collision CheckCollision(BallObject& one, GameObject& two) // AABB - Circle collision
+uint64_t Game::StateHash() const
 {
-	// get center point circle first 
-	glm::vec2 center(one.Position + one.Radius);
-	// calculate AABB info (center, half-extents)
-	glm::vec2 aabb_half_extents(two.Size.x / 2.0f, two.Size.y / 2.0f);
-	glm::vec2 aabb_center(two.Position.x + aabb_half_extents.x, two.Position.y + aabb_half_extents.y);
-	// get difference vector between both centers
-	glm::vec2 difference = center - aabb_center;
-	glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
-	// add clamped value to AABB_center and we get the value of box closest to circle
-	glm::vec2 closest = aabb_center + clamped;
-	// retrieve vector between center circle and closest point AABB and check if length <= radius
-	difference = closest - center;
-	
-	if (glm::length(difference) < one.Radius)
-		return std::make_tuple(true, VectorDirection(difference), difference);
-	else
-		return std::make_tuple(false, UP, glm::vec2(0.0f, 0.0f));
+	uint64_t hash = 14695981039346656037ull;
+	hash = hashBytes(hash, &this->State, sizeof(this->State));
+	hash = hashBytes(hash, &this->Level, sizeof(this->Level));
+	hash = hashBytes(hash, &Player->Position, sizeof(Player->Position));
+	hash = hashBytes(hash, &this->Balls.Count, sizeof(this->Balls.Count));
+	hash = hashArray(hash, this->Balls.PositionX, this->Balls.Count);
+	hash = hashArray(hash, this->Balls.PositionY, this->Balls.Count);
+	hash = hashArray(hash, this->Balls.VelocityX, this->Balls.Count);
+	hash = hashArray(hash, this->Balls.VelocityY, this->Balls.Count);
+	hash = hashArray(hash, this->Balls.Stuck, this->Balls.Count);
+	const GameLevel &level = this->Levels[this->Level];
+	return hashArray(hash, level.BrickFlags, level.BrickCount);
 }
 
-Direction VectorDirection(glm::vec2 target)
+void Game::DoCollisions(float dt)
 {
-	glm::vec2 compass[] = {
-		glm::vec2(0.0f, 1.0f), // Up
-		glm::vec2(1.0f, 0.0f), // Right
-		glm::vec2(0.0f, -1.0f), // Down
-		glm::vec2(-1.0f, 0.0f)  // Left
-	};
-	float max = 0.0f;
-	unsigned int best_match = -1;
-	for (unsigned int i = 0; i < 4; i++)
+	PROFILE_SCOPE("DoCollisions");
+	GameLevel& level = this->Levels[this->Level];
+	float width = static_cast<float>(this->Width);
+	// Every ball sees the bricks as they were at the start of the step and
+	// writes only its own state, so the balls can be swept on any number of
+	// threads with the same result; hits go to the sweeping worker's buffer
+	Jobs->ParallelFor(this->Balls.Count, BALLS_PER_JOB, [&](unsigned int first, unsigned int last, unsigned int worker)
 	{
-		float dot_product = glm::dot(glm::normalize(target), compass[i]);
-		if (dot_product > max)
-		{
-			max = dot_product;
-			best_match = i;
-		}
+		this->Balls.Sweep(first, last, dt, level, *Player, width, WorkerHits[worker], BrickCandidates[worker]);
+	});
+	// Merge in ball order, which doesn't depend on how chunks were spread over
+	// the workers; a ball's own hits are all in one buffer and keep their order
+	BallHits.clear();
+	for (std::vector<BrickHit> &hits : WorkerHits)
+	{
+		BallHits.insert(BallHits.end(), hits.begin(), hits.end());
+		hits.clear();
 	}
-	return (Direction)best_match;
-}
\ No newline at end of file
+	std::stable_sort(BallHits.begin(), BallHits.end(),
+		[](const BrickHit &a, const BrickHit &b) { return a.Ball < b.Ball; });
+	// All balls that reached a brick this step bounced off it; it is destroyed once
+	for (const BrickHit &hit : BallHits)
+		level.DestroyBrick(hit.Brick);
+}
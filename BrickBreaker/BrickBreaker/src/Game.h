@@ -1,6 +1,10 @@
 #pragma once
 
 #include "GameLevel.h"
+#include "BallSystem.h"
+#include "Collision.h"
+
+#include <cstdint>
 
 #include <glad/glad.h>
 #include "GLFW/glfw3.h"
@@ -13,17 +17,6 @@ enum GameState
 	GAME_PAUSE
 };
 
-// Four collision directions
-enum Direction {
-	UP,
-	RIGHT,
-	DOWN,
-	LEFT
-};
-
-// Defines a collision typedef that represents collision data
-typedef std::tuple<bool, Direction, glm::vec2> Collision; // <collision?>, what direction?, difference vector center - closest point>
-
 // Initialize size of the player paddle
 const glm::vec2 PLAYER_SIZE(100.0f, 20.0f);
 // Initialize velocity of the player paddle
@@ -32,6 +25,14 @@ const float PLAYER_VELOCITY(500.0f);
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
+// Most contacts the ball resolves within a single step
+const unsigned int MAX_BALL_BOUNCES = 8;
+// Widest angle from straight up a ball is served at when several are served at once
+const float BALL_SPREAD = 60.0f;
+// Most balls that leave a particle trail
+const unsigned int MAX_BALL_TRAILS = 64;
+// Balls swept per job when collisions are resolved in parallel
+const unsigned int BALLS_PER_JOB = 64;
 
 
 class Game
@@ -43,18 +44,35 @@ public:
 	unsigned int Width, Height;
 	std::vector<GameLevel> Levels;
 	unsigned int Level;
+	// Every ball in play
+	BallSystem Balls;
+	// Number of balls served on the paddle after every reset
+	unsigned int BallCount;
+	// Number of threads collisions are resolved on, 0 for one per core
+	unsigned int Threads;
+	// Seeds the game's random number generators, so sessions can be replayed
+	unsigned int Seed;
+	// Simulation only: no shaders, textures, renderers or other GL state
+	bool Headless;
 
-	Game(unsigned int width, unsigned int height);
+	Game(unsigned int width, unsigned int height, bool headless = false);
 	~Game();
 	// Initialize game state (shaders/textures/levels)
 	void Init();
 	// Game loop
 	void ProcessInput(float dt);
 	void Update(float dt);
-	void Render();
-	// Collision detection
-	void DoCollisions();
+	// Runs one fixed simulation step: input and update
+	void Step(float dt);
+	// Renders the state alpha [0, 1] of the way from the previous step to the current one
+	void Render(float alpha = 1.0f);
+	// Moves the balls through the step in parallel, resolving every contact along the way
+	void DoCollisions(float dt);
 	// Reset
 	void ResetLevel();
 	void ResetPlayer();
+	// Hash of everything the simulation depends on: state, level, paddle, balls and bricks
+	uint64_t StateHash() const;
+	// Puts count balls on the paddle, fanned out over BALL_SPREAD on either side of straight up
+	void SpawnBalls(unsigned int count);
 };
\ No newline at end of file
@@ -1,91 +1,286 @@
 #include "GameLevel.h"
+#include "MappedFile.h"
 
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
-void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+namespace
 {
-	// Clear old data
-	this->Bricks.clear();
-	// Load from file
-	unsigned int tileCode;
-	GameLevel level;
-	std::string line;
-	std::ifstream fstream(file);
-	std::vector<std::vector<unsigned int>> tileData;
-	if (fstream)
+	inline bool isBlank(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	// Scans the tile codes on the line of level text starting at text and calls
+	// visit(x, code) for each. Like operator>> the line ends at the first word
+	// that isn't a number. Returns the start of the next line.
+	template <typename Visit>
+	const char *scanLine(const char *text, const char *end, Visit visit)
 	{
-		while (std::getline(fstream, line)) // Reach each line from level file
+		unsigned int x = 0;
+		while (text < end && *text != '\n')
 		{
-			std::istringstream sstream(line);
-			std::vector<unsigned int> row;
-			while (sstream >> tileCode) // Reach each word separated by spaces
-				row.push_back(tileCode);
-			tileData.push_back(row);
+			if (isBlank(*text))
+			{
+				++text;
+				continue;
+			}
+			if (*text < '0' || *text > '9')
+			{
+				text = static_cast<const char *>(std::memchr(text, '\n', end - text));
+				return text ? text + 1 : end;
+			}
+			unsigned int code = 0;
+			do
+				code = code * 10 + (*text++ - '0');
+			while (text < end && *text >= '0' && *text <= '9');
+			visit(x++, code);
+		}
+		return text < end ? text + 1 : end;
+	}
+
+	// First pass over level text: the first line sets the width, every line is a row
+	// and count is the number of bricks; false if the first line has no tiles
+	bool measureLevel(const char *text, const char *end, unsigned int &width, unsigned int &height, unsigned int &count)
+	{
+		width = height = count = 0;
+		scanLine(text, end, [&width](unsigned int, unsigned int) { ++width; });
+		if (width == 0)
+			return false;
+		const unsigned int columns = width;
+		while (text < end)
+		{
+			text = scanLine(text, end, [&count, columns](unsigned int x, unsigned int code) { count += x < columns && code != 0; });
+			++height;
+		}
+		return true;
+	}
+
+	// Second pass: calls visit(x, y, code) for every brick on the width x height grid
+	template <typename Visit>
+	void scanLevel(const char *text, const char *end, unsigned int width, Visit visit)
+	{
+		for (unsigned int y = 0; text < end; ++y)
+		{
+			text = scanLine(text, end, [&visit, width, y](unsigned int x, unsigned int code)
+			{
+				if (x < width && code != 0)
+					visit(x, y, code);
+			});
 		}
-		if (tileData.size() > 0)
-			this->init(tileData, levelWidth, levelHeight);
 	}
 }
 
+void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+{
+	// Clear old data
+	this->clear();
+	// Cooked levels come parsed already, straight from the asset pack
+	const PackEntry *cooked = ResourceManager::Pack.Find(file, PACK_LEVEL);
+	if (cooked)
+	{
+		if (cooked->Width > 0 && cooked->Height > 0)
+			this->init(reinterpret_cast<const unsigned int *>(ResourceManager::Pack.Data(*cooked)),
+				cooked->Width, cooked->Height, levelWidth, levelHeight);
+		return;
+	}
+	// Parse the level text in place: one pass to size the arrays, one to fill them
+	MappedFile mapped;
+	if (!mapped.Open(file))
+		return;
+	const char *text = reinterpret_cast<const char *>(mapped.Data);
+	const char *end = text + mapped.Size;
+	unsigned int width, height, count;
+	if (!measureLevel(text, end, width, height, count))
+		return;
+	this->setup(width, height, count, levelWidth, levelHeight);
+	scanLevel(text, end, width, [this](unsigned int x, unsigned int y, unsigned int code) { this->addBrick(x, y, code); });
+}
+
+void GameLevel::Load(const LevelTiles &level, unsigned int levelWidth, unsigned int levelHeight)
+{
+	// Clear old data
+	this->clear();
+	if (level.Width > 0 && level.Height > 0)
+		this->init(level.Tiles.data(), level.Width, level.Height, levelWidth, levelHeight);
+}
+
+void GameLevel::ResolveSprites()
+{
+	// Look the brick sprites up once rather than for every brick
+	TextureHandle solidSprite = ResourceManager::FindTexture("block_solid");
+	TextureHandle blockSprite = ResourceManager::FindTexture("block");
+	for (unsigned int brick = 0; brick < this->BrickCount; ++brick)
+		this->BrickSprites[brick] = this->BrickFlags[brick] & BRICK_SOLID ? solidSprite : blockSprite;
+}
+
+bool GameLevel::ReadTiles(const char *file, std::vector<unsigned int> &tiles, unsigned int &width, unsigned int &height)
+{
+	MappedFile mapped;
+	if (!mapped.Open(file))
+		return false;
+	const char *text = reinterpret_cast<const char *>(mapped.Data);
+	const char *end = text + mapped.Size;
+	unsigned int count;
+	if (!measureLevel(text, end, width, height, count))
+		return false;
+	// Missing tiles in shorter rows are empty
+	tiles.assign(static_cast<size_t>(width) * height, 0);
+	scanLevel(text, end, width, [&tiles, width](unsigned int x, unsigned int y, unsigned int code) { tiles[static_cast<size_t>(y) * width + x] = code; });
+	return true;
+}
+
+glm::vec3 GameLevel::BrickColor(unsigned int type)
+{
+	if (type == 1) // Solid
+		return glm::vec3(0.8f, 0.8f, 0.7f);
+	if (type == 2)
+		return glm::vec3(0.2f, 0.6f, 1.0f);
+	if (type == 3)
+		return glm::vec3(0.0f, 0.7f, 0.0f);
+	if (type == 4)
+		return glm::vec3(0.8f, 0.8f, 0.4f);
+	if (type == 5)
+		return glm::vec3(1.0f, 0.5f, 0.0f);
+	return glm::vec3(1.0f); // Original: white
+}
+
 void GameLevel::Draw(SpriteRenderer &renderer)
 {
-	for (GameObject &tile : this->Bricks)
-		if (!tile.Destroyed)
-			tile.Draw(renderer);
+	for (unsigned int brick : this->LiveBricks())
+		renderer.DrawSprite(ResourceManager::GetTexture(this->BrickSprites[brick]), this->BrickPositions[brick], this->TileSize, 0.0f, this->BrickColors[brick]);
 }
 
-bool GameLevel::IsCompleted()
+void GameLevel::Draw(SpriteBatch &batch)
 {
-	for (GameObject &tile : this->Bricks)
-		if (!tile.IsSolid && !tile.Destroyed)
-			return false;
+	for (unsigned int brick : this->LiveBricks())
+		batch.Submit(ResourceManager::GetTexture(this->BrickSprites[brick]), this->BrickPositions[brick], this->TileSize, 0.0f, this->BrickColors[brick]);
+}
+
+bool GameLevel::IsCompleted() const
+{
+	return this->BricksLeft == 0;
+}
+
+bool GameLevel::DestroyBrick(unsigned int brick)
+{
+	if (this->BrickFlags[brick] & (BRICK_SOLID | BRICK_DESTROYED))
+		return false;
+	this->BrickFlags[brick] |= BRICK_DESTROYED;
+	--this->BricksLeft;
+	this->liveDirty = true;
+	this->destroyed.push_back(brick);
 	return true;
 }
 
-void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
+void GameLevel::Reset()
 {
-	// Calculate dimensions
-	unsigned int height = tileData.size();
-	unsigned int width = tileData[0].size();
-	float unit_width = levelWidth / static_cast<float>(width);
-	float unit_height = levelHeight / height;
-	// Initialize level tiles based on titleData
-	for (unsigned int y = 0; y < height; y++)
+	if (this->destroyed.empty())
+		return;
+	for (unsigned int brick : this->destroyed)
+		this->BrickFlags[brick] &= ~BRICK_DESTROYED;
+	this->BricksLeft += static_cast<unsigned int>(this->destroyed.size());
+	this->destroyed.clear();
+	// Every brick is live again; rewriting the list in order is a linear pass but keeps its capacity
+	this->liveBricks.resize(this->BrickCount);
+	std::iota(this->liveBricks.begin(), this->liveBricks.end(), 0u);
+	this->liveDirty = false;
+}
+
+const std::vector<unsigned int> &GameLevel::LiveBricks()
+{
+	// Compact once for all bricks destroyed since the last call, keeping the order
+	if (this->liveDirty)
 	{
-		for (unsigned int x = 0; x < width; x++)
+		this->liveBricks.erase(std::remove_if(this->liveBricks.begin(), this->liveBricks.end(),
+			[this](unsigned int brick) { return (this->BrickFlags[brick] & BRICK_DESTROYED) != 0; }), this->liveBricks.end());
+		this->liveDirty = false;
+	}
+	return this->liveBricks;
+}
+
+void GameLevel::QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int> &result) const
+{
+	result.clear();
+	if (this->Grid.empty())
+		return;
+	// Box is entirely outside of the level area
+	glm::vec2 levelSize = this->TileSize * glm::vec2(this->GridWidth, this->GridHeight);
+	if (max.x < 0.0f || max.y < 0.0f || min.x > levelSize.x || min.y > levelSize.y)
+		return;
+	// Tile range covered by the box, clamped to the grid
+	glm::ivec2 first = glm::ivec2(glm::floor(glm::max(min, glm::vec2(0.0f)) / this->TileSize));
+	glm::ivec2 last = glm::ivec2(glm::floor(max / this->TileSize));
+	first = glm::min(first, glm::ivec2(this->GridWidth - 1, this->GridHeight - 1));
+	last = glm::min(last, glm::ivec2(this->GridWidth - 1, this->GridHeight - 1));
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		for (int x = first.x; x <= last.x; ++x)
 		{
-			// Check block type from level data (2D level array)
-			if (tileData[y][x] == 1) // Solid
-			{
-				glm::vec2 pos(unit_width * x, unit_height * y);
-				glm::vec2 size(unit_width, unit_height);
-				GameObject obj(pos, size,
-					ResourceManager::GetTexture("block_solid"),
-					glm::vec3(0.8f, 0.8f, 0.7f)
-				);
-				obj.IsSolid = true;
-				this->Bricks.push_back(obj);
-			}
-			else if (tileData[y][x] > 1)
-			{
-				glm::vec3 color = glm::vec3(1.0f); // Original: white
-				if (tileData[y][x] == 2)
-					color = glm::vec3(0.2f, 0.6f, 1.0f);
-				else if (tileData[y][x] == 3)
-					color = glm::vec3(0.0f, 0.7f, 0.0f);
-				else if (tileData[y][x] == 4)
-					color = glm::vec3(0.8f, 0.8f, 0.4f);
-				else if (tileData[y][x] == 5)
-					color = glm::vec3(1.0f, 0.5f, 0.0f);
-
-				glm::vec2 pos(unit_width * x, unit_height * y);
-				glm::vec2 size(unit_width, unit_height);
-				this->Bricks.push_back(
-					GameObject(pos, size, ResourceManager::GetTexture("block"), color)
-				);
-			}
+			int brick = this->Grid[y * this->GridWidth + x];
+			if (brick >= 0 && !(this->BrickFlags[brick] & BRICK_DESTROYED))
+				result.push_back(brick);
 		}
 	}
 }
 
+void GameLevel::clear()
+{
+	this->BrickPositions.clear();
+	this->BrickColors.clear();
+	this->BrickSprites.clear();
+	this->BrickFlags.clear();
+	this->liveBricks.clear();
+	this->destroyed.clear();
+	this->BrickCount = this->BricksLeft = 0;
+	this->liveDirty = false;
+	this->Grid.clear();
+	this->GridWidth = this->GridHeight = 0;
+}
+
+void GameLevel::init(const unsigned int *tiles, unsigned int width, unsigned int height, unsigned int levelWidth, unsigned int levelHeight)
+{
+	size_t tileCount = static_cast<size_t>(width) * height;
+	unsigned int count = static_cast<unsigned int>(tileCount - std::count(tiles, tiles + tileCount, 0u));
+	this->setup(width, height, count, levelWidth, levelHeight);
+	// Initialize level tiles based on titleData
+	for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++)
+			if (tiles[y * width + x] != 0)
+				this->addBrick(x, y, tiles[y * width + x]);
+}
+
+void GameLevel::setup(unsigned int width, unsigned int height, unsigned int count, unsigned int levelWidth, unsigned int levelHeight)
+{
+	// Calculate dimensions
+	float unit_width = levelWidth / static_cast<float>(width);
+	float unit_height = levelHeight / static_cast<float>(height);
+	// Each tile holds at most one brick, so the grid maps tiles straight to bricks
+	this->GridWidth = width;
+	this->GridHeight = height;
+	this->TileSize = glm::vec2(unit_width, unit_height);
+	this->Grid.assign(static_cast<size_t>(width) * height, -1);
+	// Size every array once
+	this->BrickPositions.reserve(count);
+	this->BrickColors.reserve(count);
+	this->BrickSprites.reserve(count);
+	this->BrickFlags.reserve(count);
+	this->liveBricks.reserve(count);
+	this->destroyed.reserve(count);
+}
+
+void GameLevel::addBrick(unsigned int x, unsigned int y, unsigned int type)
+{
+	bool solid = type == 1;
+	this->Grid[static_cast<size_t>(y) * this->GridWidth + x] = static_cast<int>(this->BrickCount);
+	this->BrickPositions.push_back(this->TileSize * glm::vec2(x, y));
+	this->BrickColors.push_back(BrickColor(type));
+	// Resolved later, on the main thread
+	this->BrickSprites.push_back(TextureHandle());
+	this->BrickFlags.push_back(solid ? BRICK_SOLID : 0);
+	this->liveBricks.push_back(this->BrickCount);
+	++this->BrickCount;
+	if (!solid)
+		++this->BricksLeft;
+}
@@ -6,23 +6,83 @@
 #include <glm/glm.hpp>
 
 #include "Resource_Manager.h"
-#include "GameObject.h"
+#include "ResourceHandle.h"
+#include "SpriteRenderer.h"
+#include "SpriteBatch.h"
+
+// A level parsed into row-major tile codes
+struct LevelTiles
+{
+	std::vector<unsigned int> Tiles;
+	unsigned int Width, Height;
+};
+
+// Flag bits kept for every brick
+enum BrickFlag : unsigned char
+{
+	BRICK_SOLID = 1 << 0,    // Can't be destroyed
+	BRICK_DESTROYED = 1 << 1
+};
 
 class GameLevel
 {
 public:
-	// Level state
-	std::vector<GameObject> Bricks;
+	// Brick state as parallel arrays, one entry per brick in tile order. A brick
+	// fills exactly one tile, so every brick is TileSize large.
+	std::vector<glm::vec2> BrickPositions;
+	std::vector<glm::vec3> BrickColors;
+	std::vector<TextureHandle> BrickSprites; // Invalid handles, drawn as the missing texture, until ResolveSprites
+	std::vector<unsigned char> BrickFlags;
+	unsigned int BrickCount;
+	// Number of bricks that still have to be destroyed to complete the level
+	unsigned int BricksLeft;
+	// Broadphase grid: the index of the brick on each tile (row-major), or -1 for an empty tile
+	std::vector<int> Grid;
+	unsigned int GridWidth, GridHeight;
+	glm::vec2 TileSize;
 	// Constructor
-	GameLevel() { }
-	// Loads level from file
+	GameLevel() : BrickCount(0), BricksLeft(0), GridWidth(0), GridHeight(0), TileSize(0.0f), liveDirty(false) { }
+	// Loads level from the asset pack or else parses it straight from the mapped file. Loading
+	// touches no other resources, so it can run on a loader thread; see ResolveSprites.
 	void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+	// Loads level from parsed tiles
+	void Load(const LevelTiles &level, unsigned int levelWidth, unsigned int levelHeight);
+	// Looks up the brick sprites once the textures are loaded; call on the main thread before drawing
+	void ResolveSprites();
+	// Parses a text level file into row-major tile codes
+	static bool ReadTiles(const char *file, std::vector<unsigned int> &tiles, unsigned int &width, unsigned int &height);
+	// Color bricks of the given tile code are drawn with
+	static glm::vec3 BrickColor(unsigned int type);
 	// Render level
 	void Draw(SpriteRenderer &renderer);
+	// Queue level in a sprite batch
+	void Draw(SpriteBatch &batch);
 	// Check if the level is completed (all non-solid tiles are destroyed)
-	bool IsCompleted();
+	bool IsCompleted() const;
+	// Marks a brick destroyed; false if it is solid or was destroyed already
+	bool DestroyBrick(unsigned int brick);
+	// Brings back every brick destroyed since the level was loaded without allocating. Only the
+	// destroyed bricks' flags are touched, but the live list is refilled in one O(BrickCount) pass.
+	void Reset();
+	// Indices of all bricks that aren't destroyed, in ascending order
+	const std::vector<unsigned int> &LiveBricks();
+	// Collects the indices of all live bricks on tiles overlapped by the box [min, max], in ascending order
+	void QueryBricks(glm::vec2 min, glm::vec2 max, std::vector<unsigned int> &result) const;
 private:
-	// Initialize level from tile data
-	void init(std::vector<std::vector<unsigned int>> tileData,
+	// Indices of live bricks; destroyed ones are only dropped when the list is next asked for
+	std::vector<unsigned int> liveBricks;
+	bool liveDirty;
+	// Undo log: the bricks destroyed since the level was loaded, in order. It has room for every
+	// brick from the start, so logging never allocates.
+	std::vector<unsigned int> destroyed;
+	// Removes all bricks
+	void clear();
+	// Initialize level from row-major tile data
+	void init(const unsigned int *tiles, unsigned int width, unsigned int height,
+		unsigned int levelWidth, unsigned int levelHeight);
+	// Sizes the grid for width x height tiles and every brick array for count bricks
+	void setup(unsigned int width, unsigned int height, unsigned int count,
 		unsigned int levelWidth, unsigned int levelHeight);
+	// Appends a brick with the given tile code on tile (x, y); tiles must come in row-major order
+	void addBrick(unsigned int x, unsigned int y, unsigned int type);
 };
\ No newline at end of file
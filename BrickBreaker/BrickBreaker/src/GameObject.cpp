@@ -1,4 +1,5 @@
 #include "GameObject.h"
+#include "Resource_Manager.h"
 
 GameObject::GameObject()
 	: Position(0.0f, 0.0f), Size(1.0f, 1.0f), Velocity(0.0f), Color(1.0f), Rotation(0.0f), Sprite(), IsSolid(false), Destroyed(false)
@@ -6,7 +7,7 @@ GameObject::GameObject()
 
 }
 
-GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color /*= glm::vec3(1.0f)*/, glm::vec2 velocity /*= glm::vec2(0.0f, 0.0f)*/)
+GameObject::GameObject(glm::vec2 pos, glm::vec2 size, TextureHandle sprite, glm::vec3 color /*= glm::vec3(1.0f)*/, glm::vec2 velocity /*= glm::vec2(0.0f, 0.0f)*/)
 	: Position(pos), Size(size), Velocity(velocity), Color(color), Rotation(0.0f), Sprite(sprite), IsSolid(false), Destroyed(false)
 {
 
@@ -14,5 +15,10 @@ GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec
 
 void GameObject::Draw(SpriteRenderer &renderer)
 {
-	renderer.DrawSprite(this->Sprite, this->Position, this->Size, this->Rotation, this->Color);
+	renderer.DrawSprite(ResourceManager::GetTexture(this->Sprite), this->Position, this->Size, this->Rotation, this->Color);
+}
+
+void GameObject::Draw(SpriteBatch &batch)
+{
+	batch.Submit(ResourceManager::GetTexture(this->Sprite), this->Position, this->Size, this->Rotation, this->Color);
 }
@@ -3,8 +3,9 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "Texture.h"
+#include "ResourceHandle.h"
 #include "SpriteRenderer.h"
+#include "SpriteBatch.h"
 
 class GameObject
 {
@@ -16,10 +17,12 @@ public:
 	bool IsSolid;
 	bool Destroyed;
 	// Render state
-	Texture2D Sprite;
+	TextureHandle Sprite;
 	// Constructor(s)
 	GameObject();
-	GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+	GameObject(glm::vec2 pos, glm::vec2 size, TextureHandle sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
 	// Draw sprite
 	virtual void Draw(SpriteRenderer &renderer);
+	// Queue sprite in a batch
+	virtual void Draw(SpriteBatch &batch);
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "GpuProfiler.h"
+
+#if PROFILE_ENABLED
+
+#include <glad/glad.h>
+
+GpuProfiler::FrameQueries GpuProfiler::frames[FRAMES_IN_FLIGHT];
+unsigned int GpuProfiler::current = 0;
+bool GpuProfiler::created = false;
+bool GpuProfiler::inPass = false;
+
+void GpuProfiler::BeginFrame()
+{
+	if (!created)
+	{
+		for (FrameQueries &frame : frames)
+		{
+			glGenQueries(MAX_PASSES, frame.Queries);
+			frame.Count = 0;
+		}
+		created = true;
+	}
+	// The frame after the current one is the oldest
+	current = (current + 1) % FRAMES_IN_FLIGHT;
+	resolve(frames[current]);
+	frames[current].Start = Profiler::Now();
+}
+
+bool GpuProfiler::BeginPass(const char *name)
+{
+	FrameQueries &frame = frames[current];
+	if (!created || inPass || frame.Count == MAX_PASSES)
+		return false;
+	frame.Names[frame.Count] = name;
+	glBeginQuery(GL_TIME_ELAPSED, frame.Queries[frame.Count]);
+	inPass = true;
+	return true;
+}
+
+void GpuProfiler::EndPass()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	++frames[current].Count;
+	inPass = false;
+}
+
+void GpuProfiler::Clear()
+{
+	if (!created)
+		return;
+	for (FrameQueries &frame : frames)
+		glDeleteQueries(MAX_PASSES, frame.Queries);
+	created = false;
+}
+
+void GpuProfiler::resolve(FrameQueries &frame)
+{
+	if (frame.Count == 0)
+		return;
+	// Queries finish in order, so the last one being available means all are
+	GLint available = 0;
+	glGetQueryObjectiv(frame.Queries[frame.Count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available)
+	{
+		uint64_t start = frame.Start;
+		for (unsigned int i = 0; i < frame.Count; ++i)
+		{
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(frame.Queries[i], GL_QUERY_RESULT, &elapsed);
+			Profiler::RecordGpu(frame.Names[i], start, start + elapsed);
+			start += elapsed;
+		}
+	}
+	frame.Count = 0;
+}
+
+#endif
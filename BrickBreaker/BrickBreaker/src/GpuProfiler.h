@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Profiler.h"
+
+#if PROFILE_ENABLED
+
+#include <cstdint>
+
+// Times the enclosing render pass on the GPU; name must be a string literal
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+// Starts the GPU timings of a new frame, once per frame before any pass
+#define PROFILE_GPU_FRAME() GpuProfiler::BeginFrame()
+
+// GpuProfiler times render passes with GL_TIME_ELAPSED queries. Results
+// become available a few frames after the passes were issued, so every
+// frame gets its own set of queries and a set is only read back once it
+// is FRAMES_IN_FLIGHT frames old; if the GPU still isn't done with it by
+// then, its timings are dropped rather than stalling the pipeline. Read
+// back passes are recorded on the profiler's GPU track, one after another
+// from the CPU time their frame started at. Elapsed time queries can't
+// nest, so a pass begun inside another one isn't timed.
+class GpuProfiler
+{
+public:
+	// Frames of queries waiting for their results
+	static const unsigned int FRAMES_IN_FLIGHT = 4;
+	// Most passes timed per frame
+	static const unsigned int MAX_PASSES = 16;
+
+	// Reads back the oldest frame's timings and starts a new frame; needs a GL context
+	static void BeginFrame();
+	// Starts timing a pass, false if it can't be timed
+	static bool BeginPass(const char *name);
+	// Stops timing the pass started last
+	static void EndPass();
+	// Deletes all queries, e.g. before the GL context goes away
+	static void Clear();
+private:
+	// Queries of one frame
+	struct FrameQueries
+	{
+		unsigned int Queries[MAX_PASSES];
+		const char *Names[MAX_PASSES];
+		unsigned int Count;
+		uint64_t Start;
+	};
+	static FrameQueries frames[FRAMES_IN_FLIGHT];
+	static unsigned int current;
+	static bool created, inPass;
+	// Private constructor, that is we do not want any actual GPU profiler objects. Its members and functions should be publicly available (static).
+	GpuProfiler();
+	// Records a frame's timings if they are all available, then forgets them
+	static void resolve(FrameQueries &frame);
+};
+
+// Times a render pass from its construction to its destruction
+class GpuProfileScope
+{
+public:
+	explicit GpuProfileScope(const char *name) : timed(GpuProfiler::BeginPass(name)) { }
+	~GpuProfileScope() { if (this->timed) GpuProfiler::EndPass(); }
+	GpuProfileScope(const GpuProfileScope &) = delete;
+	GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+private:
+	bool timed;
+};
+
+#else
+
+#define PROFILE_GPU_SCOPE(name)
+#define PROFILE_GPU_FRAME()
+
+#endif
@@ -0,0 +1,150 @@
+#include "Headless.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "Game.h"
+#include "Replay.h"
+#include "Profiler.h"
+
+// Same playfield as the windowed game
+const unsigned int HEADLESS_WIDTH = 800;
+const unsigned int HEADLESS_HEIGHT = 600;
+
+namespace
+{
+	// Plays a recorded session as fast as possible and checks it still ends up in the recorded states
+	int runReplay(const char *file, unsigned int threads)
+	{
+		Replay replay;
+		if (!replay.Open(file))
+		{
+			std::cerr << "ERROR::HEADLESS: Can't read replay " << file << std::endl;
+			return -1;
+		}
+		if (replay.Header.Width != HEADLESS_WIDTH || replay.Header.Height != HEADLESS_HEIGHT)
+		{
+			std::cerr << "ERROR::HEADLESS: Replay was recorded on a " << replay.Header.Width << "x" << replay.Header.Height << " playfield" << std::endl;
+			return -1;
+		}
+		Game game(HEADLESS_WIDTH, HEADLESS_HEIGHT, true);
+		replay.Configure(game);
+		game.Threads = threads;
+		game.Init();
+
+		auto start = std::chrono::steady_clock::now();
+		unsigned long long steps = replay.Run(game);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cout << steps << " steps (" << steps * replay.Header.Step << " s recorded) replayed in " << seconds << " s, "
+			<< steps / seconds << " steps/s" << std::endl;
+		std::cout << replay.Matched << " checkpoints matched, " << replay.Mismatched << " diverged";
+		if (replay.Mismatched > 0)
+			std::cout << " (first after step " << replay.FirstMismatch << ")";
+		std::cout << std::endl;
+		if (replay.Malformed)
+			return -1;
+		return replay.Mismatched > 0 ? 1 : 0;
+	}
+
+	// Exports the profiler capture if one was asked for
+	void writeTrace(const char *file)
+	{
+		if (!file)
+			return;
+#if PROFILE_ENABLED
+		if (!Profiler::ExportChromeTrace(file))
+			std::cerr << "ERROR::HEADLESS: Can't write trace " << file << std::endl;
+#else
+		std::cerr << "ERROR::HEADLESS: Profiling is compiled out of this build, no trace written" << std::endl;
+#endif
+	}
+}
+
+int RunHeadless(int argc, char* argv[])
+{
+	unsigned long long frames = 1000000;
+	unsigned int level = 0;
+	float dt = 1.0f / 120.0f;
+	unsigned int balls = 1;
+	unsigned int threads = 0;
+	const char *recordFile = nullptr;
+	const char *replayFile = nullptr;
+	const char *profileFile = nullptr;
+	PROFILE_THREAD("Main");
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--frames" && i + 1 < argc)
+			frames = std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--level" && i + 1 < argc)
+			level = std::atoi(argv[++i]) - 1;
+		else if (arg == "--dt" && i + 1 < argc)
+			dt = static_cast<float>(std::atof(argv[++i]));
+		else if (arg == "--balls" && i + 1 < argc)
+		{
+			// Without a ball in play every step would reset the level
+			balls = std::strtoul(argv[++i], nullptr, 10);
+			if (balls < 1)
+			{
+				std::cerr << "ERROR::HEADLESS: Invalid ball count " << argv[i] << ", need at least 1" << std::endl;
+				return -1;
+			}
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+			threads = std::strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--record" && i + 1 < argc)
+			recordFile = argv[++i];
+		else if (arg == "--replay" && i + 1 < argc)
+			replayFile = argv[++i];
+		else if (arg == "--profile" && i + 1 < argc)
+			profileFile = argv[++i];
+	}
+	if (replayFile)
+	{
+		int result = runReplay(replayFile, threads);
+		writeTrace(profileFile);
+		return result;
+	}
+
+	Game game(HEADLESS_WIDTH, HEADLESS_HEIGHT, true);
+	game.BallCount = balls;
+	game.Threads = threads;
+	game.Init();
+	if (level >= game.Levels.size())
+	{
+		std::cerr << "ERROR::HEADLESS: No level " << level + 1 << std::endl;
+		return -1;
+	}
+	game.Level = level;
+	game.ResetLevel();
+	game.ResetPlayer();
+	// Hold space so the balls are launched again after every reset
+	game.Keys[GLFW_KEY_SPACE] = true;
+	ReplayRecorder recorder;
+	if (recordFile && !recorder.Begin(recordFile, game, dt))
+	{
+		std::cerr << "ERROR::HEADLESS: Can't write replay " << recordFile << std::endl;
+		return -1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned long long frame = 0; frame < frames; ++frame)
+	{
+		if (recorder.IsRecording())
+			recorder.Step(game);
+		else
+			game.Step(dt);
+	}
+	recorder.End();
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << frames << " frames (" << frames * dt << " s simulated) in " << seconds << " s, "
+		<< frames / seconds << " frames/s" << std::endl;
+	std::cout << "Level " << game.Level + 1 << ": " << game.Levels[game.Level].BricksLeft << " bricks left, " << game.Balls.Count << " balls in play"
+		<< (game.Levels[game.Level].IsCompleted() ? ", completed" : "") << std::endl;
+	writeTrace(profileFile);
+	return 0;
+}
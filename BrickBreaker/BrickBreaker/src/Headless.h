@@ -0,0 +1,15 @@
+#pragma once
+
+// Runs the game simulation without a window or GL context, as fast as the
+// CPU allows, and prints throughput and the final level state. Options:
+//   --frames N   number of simulation steps to run (default 1000000)
+//   --level N    level to play, 1-4 (default 1)
+//   --dt S       step length in seconds (default 1/120)
+//   --balls N    balls served after every reset (default 1)
+//   --threads N  collision threads, 0 for one per core (default 0)
+//   --record F   records the run to replay file F
+//   --replay F   plays replay file F instead, checking every checkpoint;
+//                fails if the simulation diverged from the recording
+//   --profile F  writes a Chrome trace of the last steps to F (profiling
+//                builds only, see Profiler.h)
+int RunHeadless(int argc, char* argv[]);
\ No newline at end of file
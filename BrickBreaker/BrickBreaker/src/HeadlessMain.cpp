@@ -0,0 +1,22 @@
+#include <cstdlib>
+#include <string>
+
+#include "Headless.h"
+#include "Benchmark.h"
+
+// Entry point of the headless build: no GLFW, no imgui, no GL context
+int main(int argc, char* argv[])
+{
+	// The CPU benchmarks need no context either
+	if (argc > 1 && std::string(argv[1]) == "--bench-particles")
+	{
+		Benchmark::ParticleUpdate();
+		return 0;
+	}
+	if (argc > 1 && std::string(argv[1]) == "--bench-levels")
+	{
+		Benchmark::LevelLoad(argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4000);
+		return 0;
+	}
+	return RunHeadless(argc, argv);
+}
@@ -0,0 +1,123 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Profiler.h"
+
+JobSystem::JobSystem(unsigned int threads /*= 0*/)
+	: WorkerCount(threads), job(nullptr), pending(0), generation(0), quit(false)
+{
+	if (this->WorkerCount == 0)
+		this->WorkerCount = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned int i = 0; i < this->WorkerCount; ++i)
+		this->queues.push_back(std::make_unique<Queue>());
+	// Worker 0 is whoever calls ParallelFor
+	for (unsigned int i = 1; i < this->WorkerCount; ++i)
+		this->threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->quit = true;
+	}
+	this->wake.notify_all();
+	for (std::thread &thread : this->threads)
+		thread.join();
+}
+
+void JobSystem::ParallelFor(unsigned int count, unsigned int grain, const RangeJob &job)
+{
+	if (count == 0)
+		return;
+	grain = std::max(grain, 1u);
+	unsigned int chunks = (count + grain - 1) / grain;
+	// Not worth waking anyone up
+	if (this->WorkerCount == 1 || chunks == 1)
+	{
+		job(0, count, 0);
+		return;
+	}
+	// Publish the job before any chunk of it can be taken
+	this->job = &job;
+	this->pending = chunks;
+	// Deal every worker a contiguous run of chunks so neighbouring indices stay on one core
+	for (unsigned int c = 0; c < chunks; ++c)
+	{
+		Queue &queue = *this->queues[static_cast<unsigned long long>(c) * this->WorkerCount / chunks];
+		std::lock_guard<std::mutex> guard(queue.Lock);
+		queue.Ranges.push_back({ c * grain, std::min(count, (c + 1) * grain) });
+	}
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		++this->generation;
+	}
+	this->wake.notify_all();
+	// Work along, then wait for the chunks still running elsewhere
+	while (this->runOne(0))
+		;
+	std::unique_lock<std::mutex> wait(this->lock);
+	this->done.wait(wait, [this] { return this->pending == 0; });
+}
+
+void JobSystem::workerLoop(unsigned int worker)
+{
+	PROFILE_THREAD("Worker " + std::to_string(worker));
+	unsigned int seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> wait(this->lock);
+			this->wake.wait(wait, [this, seen] { return this->quit || this->generation != seen; });
+			if (this->quit)
+				return;
+			seen = this->generation;
+		}
+		while (this->runOne(worker))
+			;
+	}
+}
+
+bool JobSystem::runOne(unsigned int worker)
+{
+	Range range;
+	bool found = false;
+	// Own queue first, newest chunk first
+	{
+		Queue &own = *this->queues[worker];
+		std::lock_guard<std::mutex> guard(own.Lock);
+		if (!own.Ranges.empty())
+		{
+			range = own.Ranges.back();
+			own.Ranges.pop_back();
+			found = true;
+		}
+	}
+	// Then steal the oldest chunk of the next busy worker
+	for (unsigned int i = 1; !found && i < this->WorkerCount; ++i)
+	{
+		Queue &victim = *this->queues[(worker + i) % this->WorkerCount];
+		std::lock_guard<std::mutex> guard(victim.Lock);
+		if (!victim.Ranges.empty())
+		{
+			range = victim.Ranges.front();
+			victim.Ranges.pop_front();
+			found = true;
+		}
+	}
+	if (!found)
+		return false;
+	{
+		PROFILE_SCOPE("Job");
+		(*this->job)(range.First, range.Last, worker);
+	}
+	if (--this->pending == 0)
+	{
+		// Notify under the lock so ParallelFor can't miss it between its check and its wait
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->done.notify_all();
+	}
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// JobSystem is a small work-stealing thread pool for data-parallel loops.
+// ParallelFor cuts an index range into chunks and deals them out to one
+// queue per worker; a worker takes chunks from the back of its own queue
+// and, once that is empty, steals from the front of the others. The calling
+// thread works along as worker 0, so a pool of one thread runs inline.
+class JobSystem
+{
+public:
+	// Processes indices [first, last) on the given worker, 0 <= worker < WorkerCount
+	typedef std::function<void(unsigned int first, unsigned int last, unsigned int worker)> RangeJob;
+	// Number of workers, including the calling thread
+	unsigned int WorkerCount;
+
+	// Uses one worker per hardware thread if threads is 0
+	JobSystem(unsigned int threads = 0);
+	~JobSystem();
+	// Runs job over [0, count) in chunks of at most grain indices and returns once all are done
+	void ParallelFor(unsigned int count, unsigned int grain, const RangeJob &job);
+private:
+	// A chunk of indices waiting to be processed
+	struct Range
+	{
+		unsigned int First, Last;
+	};
+	// Chunks dealt to one worker
+	struct Queue
+	{
+		std::mutex Lock;
+		std::deque<Range> Ranges;
+	};
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<Queue>> queues;
+	// Job of the current ParallelFor
+	const RangeJob *job;
+	// Chunks of the current ParallelFor that haven't finished yet
+	std::atomic<unsigned int> pending;
+	// Wakes the workers for a new ParallelFor and signals its completion
+	std::mutex lock;
+	std::condition_variable wake, done;
+	unsigned int generation;
+	bool quit;
+	// Runs on every thread but the calling one
+	void workerLoop(unsigned int worker);
+	// Runs one chunk from the worker's own queue or stolen from another; false if there was none
+	bool runOne(unsigned int worker);
+};
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// MappedFile maps a whole file read-only into memory, so its contents can
+// be used in place without being read or copied. The mapping lives until
+// Close or destruction.
+class MappedFile
+{
+public:
+	// Start and size of the mapping; null and 0 while nothing is mapped
+	const unsigned char *Data;
+	size_t Size;
+
+	MappedFile();
+	~MappedFile();
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	// Maps a file, replacing any previous mapping; false if it can't be opened or is empty
+	bool Open(const char *file);
+	// Unmaps the file
+	void Close();
+private:
+#ifdef _WIN32
+	void *fileHandle;
+	void *mappingHandle;
+#endif
+};
\ No newline at end of file
@@ -1,60 +1,101 @@
 #include "ParticleGenerator.h"
+#include "RenderState.h"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-	: shader(shader), texture(texture), amount(amount)
+#include <cstddef>
+
+// Part of the atlas page the particle texture covers
+constexpr UniformHandle REGION_UNIFORM("region");
+
+ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, PoolExhaustion policy /*= EXHAUST_STEAL_OLDEST*/)
+	: pool(amount, policy), amount(amount), shader(shader), texture(texture)
 {
 	this->init();
 }
 
+ParticleGenerator::~ParticleGenerator()
+{
+	glDeleteVertexArrays(1, &this->VAO);
+	glDeleteBuffers(1, &this->quadVBO);
+	glDeleteBuffers(1, &this->instanceVBO);
+}
+
 void ParticleGenerator::Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset)
 {
-	// Add new particles
-	for (unsigned int i = 0; i < newParticles; ++i)
-	{
-		int unusedParticle = this->firstUnusedParticle();
-		this->respawnParticle(this->particles[unusedParticle], object, offset);
-	}
+	this->Spawn(object.Position, object.Velocity, newParticles, offset);
+	this->Update(dt);
+}
 
-	// Update all particles
-	for (unsigned int i = 0; i < this->amount; ++i)
-	{
-		Particle& p = this->particles[i];
-		p.Life -= dt; // Reduce life
-		if (p.Life > 0.0f)
-		{
-			// Particle is alive, thus update
-			p.Position -= p.Velocity * dt;
-			p.Color.a -= dt * 2.5f;
-		}
-	}
+void ParticleGenerator::Spawn(glm::vec2 position, glm::vec2 velocity, unsigned int newParticles, glm::vec2 offset)
+{
+	// The pool hands out the whole burst as one range of free slots
+	unsigned int first;
+	unsigned int spawned = this->pool.Allocate(newParticles, first);
+	// Draw the random numbers for the whole burst at once
+	if (this->randomValues.size() < spawned * 2)
+		this->randomValues.resize(spawned * 2);
+	this->random.Fill(this->randomValues.data(), spawned * 2);
+	for (unsigned int i = 0; i < spawned; ++i)
+		this->respawnParticle(first + i, position, velocity, offset, this->randomValues[i * 2], this->randomValues[i * 2 + 1]);
+}
+
+void ParticleGenerator::Update(float dt)
+{
+	// Update all live particles and drop the ones that died
+	this->pool.Update(dt);
 }
 
 // Render all particles
 void ParticleGenerator::Draw()
 {
-	// Use additive blending to give it a "glow" effect
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-	this->shader.Use();
-	for (Particle particle : this->particles)
+	// The pool keeps live particles compacted, so its first Count entries are exactly what is drawn.
+	// Mapping an empty range is an error, so a generator without particles draws nothing.
+	unsigned int count = this->pool.Count;
+	if (count == 0)
+		return;
+	// Copy the live range into the instance buffer, orphaning last frame's contents
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	if (this->pool.Capacity > this->amount)
 	{
-		if (particle.Life > 0.0f)
-		{
-			this->shader.SetVector2f("offset", particle.Position);
-			this->shader.SetVector4f("color", particle.Color);
-			this->texture.Bind();
-			glBindVertexArray(this->VAO);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-			glBindVertexArray(0);
-		}
+		// The pool grew, follow it
+		this->amount = this->pool.Capacity;
+		glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
 	}
+	void *mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(ParticleInstance),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (!mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		return;
+	}
+	ParticleInstance *instances = static_cast<ParticleInstance *>(mapped);
+	const ParticlePool &p = this->pool;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		instances[i].Offset = glm::vec2(p.PositionX[i], p.PositionY[i]);
+		instances[i].Color = glm::vec4(p.ColorR[i], p.ColorG[i], p.ColorB[i], p.ColorA[i]);
+	}
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	// Use additive blending to give it a "glow" effect
+	RenderState::BlendFunc(GL_SRC_ALPHA, GL_ONE);
+	this->shader.Use();
+	this->shader.SetVector4f(REGION_UNIFORM, this->texture.Region);
+	RenderState::ActiveTexture(GL_TEXTURE0);
+	this->texture.Bind();
+	RenderState::BindVertexArray(this->VAO);
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
 	// Reset to default blending mode
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	RenderState::BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void ParticleGenerator::Seed(unsigned int seed)
+{
+	this->random.Seed(seed);
 }
 
 void ParticleGenerator::init()
 {
 	// Set up mesh and attribute properties
-	unsigned int VBO;
 	float particle_quad[] = {
 		0.0f, 1.0f, 0.0f, 1.0f,
 		1.0f, 0.0f, 1.0f, 0.0f,
@@ -65,54 +106,42 @@ void ParticleGenerator::init()
 		1.0f, 0.0f, 1.0f, 0.0f
 	};
 	glGenVertexArrays(1, &this->VAO);
-	glGenBuffers(1, &VBO);
-	glBindVertexArray(this->VAO);
+	glGenBuffers(1, &this->quadVBO);
+	glGenBuffers(1, &this->instanceVBO);
+	RenderState::BindVertexArray(this->VAO);
 	// Fill mesh buffer
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
 	// Set mesh attributes
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-	glBindVertexArray(0);
-
-	// Create this->amount default particle instances
-	for (unsigned int i = 0; i < this->amount; ++i)
-		this->particles.push_back(Particle());
-}
-
-// Stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
-unsigned int ParticleGenerator::firstUnusedParticle()
-{
-	// First search from last used particle, this will usually return almost instantly
-	for (unsigned int i = lastUsedParticle; i < this->amount; ++i)
-	{
-		if (this->particles[i].Life <= 0.0f)
-		{
-			lastUsedParticle = i;
-			return i;
-		}
-	}
-	// Otherwise, do a linear search
-	for (unsigned int i = 0; i < lastUsedParticle; ++i)
-	{
-		if (this->particles[i].Life <= 0.0f)
-		{
-			lastUsedParticle = i;
-			return i;
-		}
-	}
-	// All particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved
-	lastUsedParticle = 0;
-	return 0;
+	// Instance buffer large enough for the whole pool, advanced once per particle; an empty pool
+	// gets its storage in Draw once it grows
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	if (this->amount > 0)
+		glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Offset));
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Color));
+	glVertexAttribDivisor(2, 1);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void ParticleGenerator::respawnParticle(Particle& particle, GameObject& object, glm::vec2 offset)
+void ParticleGenerator::respawnParticle(unsigned int index, glm::vec2 position, glm::vec2 velocity, glm::vec2 offset, float spread, float shade)
 {
-	float random = ((rand() % 100) - 50) / 10.0f;
-	float rColor = 0.5f + ((rand() % 100) / 100.0f);
-	particle.Position = object.Position + random + offset;
-	particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-	particle.Life = 1.0f;
-	particle.Velocity = object.Velocity * 0.1f;
+	float random = spread * 10.0f - 5.0f;
+	float rColor = 0.5f + shade;
+	position += random + offset;
+	velocity *= 0.1f;
+	this->pool.PositionX[index] = position.x;
+	this->pool.PositionY[index] = position.y;
+	this->pool.VelocityX[index] = velocity.x;
+	this->pool.VelocityY[index] = velocity.y;
+	this->pool.ColorR[index] = rColor;
+	this->pool.ColorG[index] = rColor;
+	this->pool.ColorB[index] = rColor;
+	this->pool.ColorA[index] = 1.0f;
+	this->pool.Life[index] = 1.0f;
 }
\ No newline at end of file
@@ -8,15 +8,14 @@
 #include "Shader.h"
 #include "Texture.h"
 #include "GameObject.h"
+#include "ParticlePool.h"
+#include "Random.h"
 
-// Represents a single particle and its state
-struct Particle
+// Per-instance particle data as it is laid out in the instance buffer
+struct ParticleInstance
 {
-	glm::vec2 Position, Velocity;
+	glm::vec2 Offset;
 	glm::vec4 Color;
-	float	  Life;
-
-	Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
 };
 
 // ParticleGenerator acts as a container for rendering a large number of
@@ -25,23 +24,36 @@ struct Particle
 class ParticleGenerator
 {
 public:
-	ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
+	ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, PoolExhaustion policy = EXHAUST_STEAL_OLDEST);
+	~ParticleGenerator();
+	// Owns its GL buffers and vertex array, which a copy would delete a second time
+	ParticleGenerator(const ParticleGenerator &) = delete;
+	ParticleGenerator &operator=(const ParticleGenerator &) = delete;
 	// Update all particles
 	void Update(float dt, GameObject& object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
-	// Render all particles
+	// Spawns particles trailing something at position moving with velocity
+	void Spawn(glm::vec2 position, glm::vec2 velocity, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+	// Update all live particles without spawning new ones
+	void Update(float dt);
+	// Render all particles with a single instanced draw call
 	void Draw();
+	// Restarts the random numbers new particles are spawned with, so spawning can be reproduced
+	void Seed(unsigned int seed);
 private:
 	// State
-	std::vector<Particle> particles;
-	unsigned int amount;
+	ParticlePool pool;
+	unsigned int amount; // Number of particles the instance buffer holds
+	Random random;
+	// Two random numbers per particle of the burst being spawned
+	std::vector<float> randomValues;
 	// Render state
 	Shader shader;
 	Texture2D texture;
 	unsigned int VAO;
+	unsigned int quadVBO;
+	unsigned int instanceVBO;
 	// Initialize buffer and vertex attributes
 	void init();
-	// Returns the first particle infex that's currently unused e.g. Life <= 0.0f or 0 if no particle is current inactive
-	unsigned int firstUnusedParticle();
-	// Respawns particle
-	void respawnParticle(Particle& particle, GameObject& object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+	// Respawns the particle at the given index; spread and shade are random numbers in [0, 1)
+	void respawnParticle(unsigned int index, glm::vec2 position, glm::vec2 velocity, glm::vec2 offset, float spread, float shade);
 };
\ No newline at end of file
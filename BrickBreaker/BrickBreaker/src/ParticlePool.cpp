@@ -0,0 +1,189 @@
+#include "ParticlePool.h"
+
+#include <algorithm>
+#include <utility>
+
+// Pick the widest vector unit the compiler targets; MSVC only defines __AVX__ with /arch:AVX
+#if defined(__AVX__)
+#include <immintrin.h>
+#define PARTICLE_POOL_AVX
+const unsigned int ParticlePool::SimdWidth = 8;
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_POOL_SSE
+const unsigned int ParticlePool::SimdWidth = 4;
+#else
+const unsigned int ParticlePool::SimdWidth = 1;
+#endif
+
+ParticlePool::ParticlePool(unsigned int capacity, PoolExhaustion policy /*= EXHAUST_STEAL_OLDEST*/)
+	: Count(0), Capacity(0), policy(policy)
+{
+	this->grow(capacity);
+}
+
+unsigned int ParticlePool::Allocate(unsigned int count, unsigned int &first)
+{
+	unsigned int available = this->Capacity - this->Count;
+	if (count > available)
+	{
+		if (this->policy == EXHAUST_GROW)
+		{
+			// Grow geometrically so repeated bursts settle quickly
+			this->grow(std::max(this->Capacity * 2, this->Count + count));
+		}
+		else if (this->policy == EXHAUST_STEAL_OLDEST)
+		{
+			// Turn the oldest particles into free slots directly behind the live range
+			unsigned int steal = std::min(count, this->Capacity) - available;
+			this->gatherOldest(steal);
+			this->Count -= steal;
+		}
+		else
+			count = available;
+	}
+	count = std::min(count, this->Capacity - this->Count);
+	first = this->Count;
+	this->Count += count;
+	return count;
+}
+
+void ParticlePool::Update(float dt)
+{
+	float *px = this->PositionX.data();
+	float *py = this->PositionY.data();
+	const float *vx = this->VelocityX.data();
+	const float *vy = this->VelocityY.data();
+	float *alpha = this->ColorA.data();
+	float *life = this->Life.data();
+	const float fade = dt * 2.5f;
+	const unsigned int count = this->Count;
+	// Index of the first particle that died this update, count if none did
+	unsigned int firstDead = count;
+	unsigned int i = 0;
+#if defined(PARTICLE_POOL_AVX)
+	const __m256 vdt = _mm256_set1_ps(dt);
+	const __m256 vfade = _mm256_set1_ps(fade);
+	const __m256 zero = _mm256_setzero_ps();
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 l = _mm256_sub_ps(_mm256_loadu_ps(life + i), vdt);
+		_mm256_storeu_ps(life + i, l);
+		_mm256_storeu_ps(px + i, _mm256_sub_ps(_mm256_loadu_ps(px + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), vdt)));
+		_mm256_storeu_ps(py + i, _mm256_sub_ps(_mm256_loadu_ps(py + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), vdt)));
+		_mm256_storeu_ps(alpha + i, _mm256_sub_ps(_mm256_loadu_ps(alpha + i), vfade));
+		if (firstDead == count && _mm256_movemask_ps(_mm256_cmp_ps(l, zero, _CMP_LE_OQ)))
+			firstDead = i;
+	}
+#elif defined(PARTICLE_POOL_SSE)
+	const __m128 vdt = _mm_set1_ps(dt);
+	const __m128 vfade = _mm_set1_ps(fade);
+	const __m128 zero = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 l = _mm_sub_ps(_mm_loadu_ps(life + i), vdt);
+		_mm_storeu_ps(life + i, l);
+		_mm_storeu_ps(px + i, _mm_sub_ps(_mm_loadu_ps(px + i), _mm_mul_ps(_mm_loadu_ps(vx + i), vdt)));
+		_mm_storeu_ps(py + i, _mm_sub_ps(_mm_loadu_ps(py + i), _mm_mul_ps(_mm_loadu_ps(vy + i), vdt)));
+		_mm_storeu_ps(alpha + i, _mm_sub_ps(_mm_loadu_ps(alpha + i), vfade));
+		if (firstDead == count && _mm_movemask_ps(_mm_cmple_ps(l, zero)))
+			firstDead = i;
+	}
+#endif
+	// Scalar tail (or the whole pool without SIMD support)
+	for (; i < count; ++i)
+	{
+		life[i] -= dt;
+		px[i] -= vx[i] * dt;
+		py[i] -= vy[i] * dt;
+		alpha[i] -= fade;
+		if (firstDead == count && life[i] <= 0.0f)
+			firstDead = i;
+	}
+
+	// Compact: fill every dead slot with the last live particle, so the cost scales with the number of deaths
+	unsigned int live = count;
+	i = firstDead;
+	while (i < live)
+	{
+		if (life[i] > 0.0f)
+		{
+			++i;
+			continue;
+		}
+		--live;
+		if (i != live)
+			this->Move(live, i); // Slot i is re-checked, the moved particle may be dead as well
+	}
+	this->Count = live;
+}
+
+void ParticlePool::Swap(unsigned int a, unsigned int b)
+{
+	std::swap(this->PositionX[a], this->PositionX[b]);
+	std::swap(this->PositionY[a], this->PositionY[b]);
+	std::swap(this->VelocityX[a], this->VelocityX[b]);
+	std::swap(this->VelocityY[a], this->VelocityY[b]);
+	std::swap(this->ColorR[a], this->ColorR[b]);
+	std::swap(this->ColorG[a], this->ColorG[b]);
+	std::swap(this->ColorB[a], this->ColorB[b]);
+	std::swap(this->ColorA[a], this->ColorA[b]);
+	std::swap(this->Life[a], this->Life[b]);
+}
+
+void ParticlePool::grow(unsigned int capacity)
+{
+	this->PositionX.resize(capacity);
+	this->PositionY.resize(capacity);
+	this->VelocityX.resize(capacity);
+	this->VelocityY.resize(capacity);
+	this->ColorR.resize(capacity, 1.0f);
+	this->ColorG.resize(capacity, 1.0f);
+	this->ColorB.resize(capacity, 1.0f);
+	this->ColorA.resize(capacity, 1.0f);
+	this->Life.resize(capacity);
+	this->lifeScratch.resize(capacity);
+	this->Capacity = capacity;
+}
+
+void ParticlePool::gatherOldest(unsigned int count)
+{
+	if (count == 0)
+		return;
+	// Find the life value of the count-th oldest particle in linear time
+	std::copy(this->Life.begin(), this->Life.begin() + this->Count, this->lifeScratch.begin());
+	std::nth_element(this->lifeScratch.begin(), this->lifeScratch.begin() + (count - 1), this->lifeScratch.begin() + this->Count);
+	float threshold = this->lifeScratch[count - 1];
+	// Everything strictly below the threshold is stolen; ties fill up the remainder
+	unsigned int below = 0;
+	for (unsigned int i = 0; i < this->Count; ++i)
+		if (this->Life[i] < threshold)
+			++below;
+	unsigned int ties = count - below;
+	// Swap the selected particles into the tail [Count - count, Count)
+	unsigned int tail = this->Count;
+	for (unsigned int i = this->Count; i-- > 0 && tail > this->Count - count;)
+	{
+		bool steal = this->Life[i] < threshold;
+		if (!steal && this->Life[i] == threshold && ties > 0)
+		{
+			steal = true;
+			--ties;
+		}
+		if (steal)
+			this->Swap(i, --tail);
+	}
+}
+
+void ParticlePool::Move(unsigned int from, unsigned int to)
+{
+	this->PositionX[to] = this->PositionX[from];
+	this->PositionY[to] = this->PositionY[from];
+	this->VelocityX[to] = this->VelocityX[from];
+	this->VelocityY[to] = this->VelocityY[from];
+	this->ColorR[to] = this->ColorR[from];
+	this->ColorG[to] = this->ColorG[from];
+	this->ColorB[to] = this->ColorB[from];
+	this->ColorA[to] = this->ColorA[from];
+	this->Life[to] = this->Life[from];
+}
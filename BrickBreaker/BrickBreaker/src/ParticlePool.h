@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+// What a full pool does when more particles are requested
+enum PoolExhaustion
+{
+	EXHAUST_DROP,         // Spawn only as many particles as there are free slots
+	EXHAUST_STEAL_OLDEST, // Recycle the particles with the least life left
+	EXHAUST_GROW          // Grow the pool to fit the request
+};
+
+// ParticlePool stores particle state as a structure of arrays so the update
+// kernel can process several particles per SIMD instruction. Live particles
+// are always kept compacted at the front of the arrays, so [0, Count) is
+// exactly the range that needs updating and rendering.
+class ParticlePool
+{
+public:
+	// Particle state, one entry per particle
+	std::vector<float> PositionX, PositionY;
+	std::vector<float> VelocityX, VelocityY;
+	std::vector<float> ColorR, ColorG, ColorB, ColorA;
+	std::vector<float> Life;
+	// Number of live particles
+	unsigned int Count;
+	// Number of particles the pool can hold
+	unsigned int Capacity;
+	// Number of particles the update kernel processes per instruction
+	static const unsigned int SimdWidth;
+
+	ParticlePool(unsigned int capacity, PoolExhaustion policy = EXHAUST_STEAL_OLDEST);
+	// Reserves up to count slots as one contiguous range starting at first and
+	// returns how many were reserved. Runs in constant time while the pool has
+	// room and in linear time (once per request, not per particle) when full.
+	unsigned int Allocate(unsigned int count, unsigned int &first);
+	// Reduces life, integrates position, fades alpha and compacts dead particles away
+	void Update(float dt);
+	// Copies the particle at index from to index to
+	void Move(unsigned int from, unsigned int to);
+	// Exchanges two particles
+	void Swap(unsigned int a, unsigned int b);
+private:
+	PoolExhaustion policy;
+	// Scratch copy of Life used to select the oldest particles without allocating
+	std::vector<float> lifeScratch;
+	// Resizes all particle arrays
+	void grow(unsigned int capacity);
+	// Moves the count particles with the least life left to the end of the live range
+	void gatherOldest(unsigned int count);
+};
@@ -0,0 +1,196 @@
+#include "Profiler.h"
+
+#if PROFILE_ENABLED
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+// Name of the series holding the frame length
+const char *const FRAME_SERIES = "Frame";
+
+std::vector<ProfileSeries> Profiler::History;
+unsigned int Profiler::Frame = 0;
+std::vector<std::unique_ptr<Profiler::ThreadEvents>> Profiler::threads;
+std::mutex Profiler::threadsLock;
+Profiler::ThreadEvents *Profiler::gpu = nullptr;
+thread_local Profiler::ThreadEvents *Profiler::current = nullptr;
+uint64_t Profiler::frameStart = 0;
+
+namespace
+{
+	const std::chrono::steady_clock::time_point EPOCH = std::chrono::steady_clock::now();
+
+	thread_local std::string threadName;
+
+	// Writes text as a JSON string
+	void writeString(std::ofstream &out, const char *text)
+	{
+		out << '"';
+		for (; *text; ++text)
+		{
+			if (*text == '"' || *text == '\\')
+				out << '\\';
+			out << *text;
+		}
+		out << '"';
+	}
+}
+
+uint64_t Profiler::Now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - EPOCH).count());
+}
+
+void Profiler::Record(const char *name, uint64_t start, uint64_t end)
+{
+	push(local(), name, start, end);
+}
+
+void Profiler::RecordGpu(const char *name, uint64_t start, uint64_t end)
+{
+	if (!gpu)
+		gpu = &add("GPU");
+	push(*gpu, name, start, end);
+}
+
+void Profiler::NameThread(const std::string &name)
+{
+	threadName = name;
+	// Rename the buffer if the thread recorded before
+	if (current)
+	{
+		std::lock_guard<std::mutex> guard(threadsLock);
+		current->Name = name;
+	}
+}
+
+void Profiler::BeginFrame()
+{
+	uint64_t now = Now();
+	if (frameStart == 0)
+	{
+		frameStart = now;
+		return;
+	}
+	unsigned int slot = Frame % HISTORY_FRAMES;
+	for (ProfileSeries &entry : History)
+		entry.Values[slot] = 0.0f;
+	series(FRAME_SERIES).Values[slot] = (now - frameStart) / 1.0e6f;
+	// Sum up what finished since the last frame on every thread
+	static std::vector<ProfileEvent> events;
+	{
+		std::lock_guard<std::mutex> guard(threadsLock);
+		for (auto &thread : threads)
+		{
+			events.clear();
+			thread->Summed = snapshot(*thread, thread->Summed, events);
+			for (const ProfileEvent &event : events)
+				series(event.Name).Values[slot] += (event.End - event.Start) / 1.0e6f;
+		}
+	}
+	frameStart = now;
+	++Frame;
+}
+
+bool Profiler::ExportChromeTrace(const char *file)
+{
+	std::ofstream out(file, std::ios::trunc);
+	if (!out)
+		return false;
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	out << "{\"traceEvents\":[";
+	bool first = true;
+	std::vector<ProfileEvent> events;
+	std::lock_guard<std::mutex> guard(threadsLock);
+	for (unsigned int t = 0; t < threads.size(); ++t)
+	{
+		const ThreadEvents &thread = *threads[t];
+		// Name the track, then list its complete ("X") events in microseconds
+		out << (first ? "\n" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":";
+		writeString(out, thread.Name.c_str());
+		out << "}}";
+		first = false;
+		events.clear();
+		snapshot(thread, 0, events);
+		for (const ProfileEvent &event : events)
+		{
+			out << ",\n{\"ph\":\"X\",\"name\":";
+			writeString(out, event.Name);
+			out << ",\"pid\":1,\"tid\":" << t << ",\"ts\":" << event.Start / 1.0e3 << ",\"dur\":" << (event.End - event.Start) / 1.0e3 << "}";
+		}
+	}
+	out << "\n]}\n";
+	return static_cast<bool>(out);
+}
+
+Profiler::ThreadEvents &Profiler::local()
+{
+	if (!current)
+		current = &add(threadName);
+	return *current;
+}
+
+Profiler::ThreadEvents &Profiler::add(const std::string &name)
+{
+	std::unique_ptr<ThreadEvents> events = std::make_unique<ThreadEvents>();
+	events->Head = 0;
+	events->Summed = 0;
+	std::lock_guard<std::mutex> guard(threadsLock);
+	events->Id = static_cast<unsigned int>(threads.size());
+	events->Name = name.empty() ? "Thread " + std::to_string(events->Id) : name;
+	threads.push_back(std::move(events));
+	return *threads.back();
+}
+
+void Profiler::push(ThreadEvents &events, const char *name, uint64_t start, uint64_t end)
+{
+	// Only the owning thread writes, so the slot can be filled before the head is published. The
+	// fence keeps the slot's stores after the previous head, so a reader that sees them sees that head.
+	uint64_t head = events.Head.load(std::memory_order_relaxed);
+	EventSlot &slot = events.Events[head & (EVENTS_PER_THREAD - 1)];
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.Name.store(name, std::memory_order_relaxed);
+	slot.Start.store(start, std::memory_order_relaxed);
+	slot.End.store(end, std::memory_order_relaxed);
+	events.Head.store(head + 1, std::memory_order_release);
+}
+
+uint64_t Profiler::snapshot(const ThreadEvents &events, uint64_t from, std::vector<ProfileEvent> &out)
+{
+	uint64_t head = events.Head.load(std::memory_order_acquire);
+	uint64_t first = head > EVENTS_PER_THREAD ? head - EVENTS_PER_THREAD : 0;
+	first = from > first ? from : first;
+	size_t copied = out.size();
+	for (uint64_t i = first; i < head; ++i)
+	{
+		const EventSlot &slot = events.Events[i & (EVENTS_PER_THREAD - 1)];
+		out.push_back({ slot.Name.load(std::memory_order_relaxed), slot.Start.load(std::memory_order_relaxed),
+			slot.End.load(std::memory_order_relaxed) });
+	}
+	// The owner kept writing while we copied; drop whatever it overwrote meanwhile. Like a seqlock, the
+	// fence makes the head read below at least as new as any slot store seen above. The owner may also
+	// be storing event after, unpublished, over event after - EVENTS_PER_THREAD.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t after = events.Head.load(std::memory_order_relaxed);
+	if (after >= first + EVENTS_PER_THREAD)
+	{
+		uint64_t stale = after + 1 - EVENTS_PER_THREAD - first;
+		stale = stale < head - first ? stale : head - first;
+		out.erase(out.begin() + copied, out.begin() + copied + static_cast<size_t>(stale));
+	}
+	return head;
+}
+
+ProfileSeries &Profiler::series(const char *name)
+{
+	for (ProfileSeries &entry : History)
+		if (entry.Name == name || std::strcmp(entry.Name, name) == 0)
+			return entry;
+	History.push_back({ name, std::vector<float>(HISTORY_FRAMES, 0.0f) });
+	return History.back();
+}
+
+#endif
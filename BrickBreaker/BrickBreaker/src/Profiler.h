@@ -0,0 +1,134 @@
+#pragma once
+
+// Profiling is compiled in unless NDEBUG is defined, i.e. it is gone from
+// release builds; define PROFILE_ENABLED as 0 or 1 to decide otherwise
+#ifndef PROFILE_ENABLED
+#ifdef NDEBUG
+#define PROFILE_ENABLED 0
+#else
+#define PROFILE_ENABLED 1
+#endif
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILE_ENABLED
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Times the enclosing scope; name must be a string literal
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+// Names the calling thread in captures
+#define PROFILE_THREAD(name) Profiler::NameThread(name)
+// Closes the frame history entry of the last frame, once per frame on the main thread
+#define PROFILE_FRAME() Profiler::BeginFrame()
+
+// A timed scope, in nanoseconds since the profiler started
+struct ProfileEvent
+{
+	const char *Name;
+	uint64_t Start, End;
+};
+
+// Milliseconds spent per frame in all scopes of one name, oldest first from Profiler::Frame
+struct ProfileSeries
+{
+	const char *Name;
+	std::vector<float> Values;
+};
+
+// Profiler collects timed scopes from every thread. Each thread writes its
+// events to a ring buffer of its own, which only it ever writes and which
+// is published with a single atomic store, so recording takes no locks and
+// never waits; when the buffer wraps, the oldest events are overwritten.
+// Once per frame the main thread sums up the new events per name into a
+// rolling history for the overlay, and a capture of everything still in
+// the buffers can be exported as Chrome trace JSON (chrome://tracing or
+// https://ui.perfetto.dev).
+class Profiler
+{
+public:
+	// Events each thread keeps, a power of two
+	static const unsigned int EVENTS_PER_THREAD = 1 << 14;
+	// Frames kept in the history
+	static const unsigned int HISTORY_FRAMES = 240;
+	// Per-frame totals by name; the first series is the length of the frame itself
+	static std::vector<ProfileSeries> History;
+	// Frames recorded so far; the newest history entry is at (Frame - 1) % HISTORY_FRAMES
+	static unsigned int Frame;
+
+	// Nanoseconds since the profiler started
+	static uint64_t Now();
+	// Records a finished scope for the calling thread
+	static void Record(const char *name, uint64_t start, uint64_t end);
+	// Records a GPU pass on a track of its own; only call from the thread owning the GL context
+	static void RecordGpu(const char *name, uint64_t start, uint64_t end);
+	// Names the calling thread in captures
+	static void NameThread(const std::string &name);
+	// Ends the current frame and starts the next one
+	static void BeginFrame();
+	// Writes every event still buffered to file as Chrome trace JSON, false if it can't be written
+	static bool ExportChromeTrace(const char *file);
+private:
+	// A buffered event; readers may copy it while the owner overwrites it, so its fields are atomic
+	struct EventSlot
+	{
+		std::atomic<const char *> Name;
+		std::atomic<uint64_t> Start, End;
+	};
+	// Events of one thread; Head counts every event ever written
+	struct ThreadEvents
+	{
+		std::string Name;
+		unsigned int Id;
+		std::atomic<uint64_t> Head;
+		// Events up to here are in the history already, only touched by BeginFrame
+		uint64_t Summed;
+		EventSlot Events[EVENTS_PER_THREAD];
+	};
+	// Buffers of all threads that ever recorded, kept when their thread ends so they can still be exported
+	static std::vector<std::unique_ptr<ThreadEvents>> threads;
+	static std::mutex threadsLock;
+	static ThreadEvents *gpu;
+	// The calling thread's buffer once it recorded
+	static thread_local ThreadEvents *current;
+	static uint64_t frameStart;
+	// Private constructor, that is we do not want any actual profiler objects. Its members and functions should be publicly available (static).
+	Profiler();
+	// The calling thread's buffer, registered on first use
+	static ThreadEvents &local();
+	// Registers a buffer; threads without a name are numbered
+	static ThreadEvents &add(const std::string &name);
+	static void push(ThreadEvents &events, const char *name, uint64_t start, uint64_t end);
+	// Appends the events from index from on that are still in a buffer, oldest first, and returns
+	// the index after them
+	static uint64_t snapshot(const ThreadEvents &events, uint64_t from, std::vector<ProfileEvent> &out);
+	static ProfileSeries &series(const char *name);
+};
+
+// Records the time between its construction and destruction
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char *name) : name(name), start(Profiler::Now()) { }
+	~ProfileScope() { Profiler::Record(this->name, this->start, Profiler::Now()); }
+	ProfileScope(const ProfileScope &) = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+private:
+	const char *name;
+	uint64_t start;
+};
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD(name)
+#define PROFILE_FRAME()
+
+#endif
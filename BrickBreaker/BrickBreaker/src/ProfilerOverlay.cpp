@@ -0,0 +1,48 @@
+#include "ProfilerOverlay.h"
+
+#if PROFILE_ENABLED
+
+#include <algorithm>
+#include <cstdio>
+
+#include <imgui.h>
+
+// Height of every graph in pixels
+const float GRAPH_HEIGHT = 40.0f;
+
+bool ProfilerOverlay::Visible = false;
+std::string ProfilerOverlay::CaptureFile = "BrickBreakerTrace.json";
+
+void ProfilerOverlay::Draw()
+{
+	if (!Visible)
+		return;
+	static std::string exported;
+	ImGui::Begin("Profiler", &Visible);
+	ImGui::Text("Milliseconds per frame over the last %u frames (F3 hides)", Profiler::HISTORY_FRAMES);
+	// Values run oldest first from the entry the next frame overwrites
+	int offset = static_cast<int>(Profiler::Frame % Profiler::HISTORY_FRAMES);
+	int newest = static_cast<int>((Profiler::Frame + Profiler::HISTORY_FRAMES - 1) % Profiler::HISTORY_FRAMES);
+	for (const ProfileSeries &series : Profiler::History)
+	{
+		float total = 0.0f, peak = 0.0f;
+		for (float value : series.Values)
+		{
+			total += value;
+			peak = std::max(peak, value);
+		}
+		char label[128];
+		std::snprintf(label, sizeof(label), "%.2f ms, avg %.2f, max %.2f", series.Values[newest], total / Profiler::HISTORY_FRAMES, peak);
+		ImGui::PushID(series.Name);
+		ImGui::PlotLines(series.Name, series.Values.data(), static_cast<int>(series.Values.size()), offset, label,
+			0.0f, peak > 0.0f ? peak * 1.1f : 1.0f, ImVec2(0.0f, GRAPH_HEIGHT));
+		ImGui::PopID();
+	}
+	if (ImGui::Button("Export Chrome trace"))
+		exported = Profiler::ExportChromeTrace(CaptureFile.c_str()) ? "Wrote " + CaptureFile : "Can't write " + CaptureFile;
+	if (!exported.empty())
+		ImGui::Text("%s", exported.c_str());
+	ImGui::End();
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Profiler.h"
+
+#if PROFILE_ENABLED
+
+#include <string>
+
+// ProfilerOverlay is an imgui window with a rolling graph of the last
+// Profiler::HISTORY_FRAMES frames for every profiled scope name, CPU and
+// GPU, and a button exporting a Chrome trace of what's still buffered.
+class ProfilerOverlay
+{
+public:
+	// Whether Draw shows the window
+	static bool Visible;
+	// File the export button writes
+	static std::string CaptureFile;
+	// Adds the window to the current imgui frame if it is visible
+	static void Draw();
+private:
+	// Private constructor, that is we do not want any actual overlay objects. Its members and functions should be publicly available (static).
+	ProfilerOverlay();
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "Random.h"
+
+// SSE2 covers every operation xoshiro128+ needs; MSVC implies it on x64
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RANDOM_SSE
+#endif
+
+namespace
+{
+	inline uint32_t rotl(uint32_t x, int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	}
+
+	// SplitMix64, used to expand a seed into generator state
+	uint64_t splitMix(uint64_t &x)
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// The top 24 bits make an exact float in [0, 1)
+	const float FLOAT_UNIT = 1.0f / 16777216.0f;
+}
+
+Random::Random(uint32_t seed /*= 1*/)
+{
+	this->Seed(seed);
+}
+
+void Random::Seed(uint32_t seed)
+{
+	uint64_t x = seed;
+	for (unsigned int i = 0; i < 4; i += 2)
+	{
+		uint64_t bits = splitMix(x);
+		this->state[i] = static_cast<uint32_t>(bits);
+		this->state[i + 1] = static_cast<uint32_t>(bits >> 32);
+	}
+	for (unsigned int lane = 0; lane < Lanes; ++lane)
+	{
+		for (unsigned int word = 0; word < 4; word += 2)
+		{
+			uint64_t bits = splitMix(x);
+			this->lanes[word][lane] = static_cast<uint32_t>(bits);
+			this->lanes[word + 1][lane] = static_cast<uint32_t>(bits >> 32);
+		}
+	}
+}
+
+uint32_t Random::Next()
+{
+	uint32_t *s = this->state;
+	uint32_t result = s[0] + s[3];
+	uint32_t t = s[1] << 9;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 11);
+	return result;
+}
+
+float Random::NextFloat()
+{
+	return (this->Next() >> 8) * FLOAT_UNIT;
+}
+
+float Random::Range(float min, float max)
+{
+	return min + (max - min) * this->NextFloat();
+}
+
+void Random::Fill(float *values, unsigned int count)
+{
+	unsigned int i = 0;
+	for (; i + Lanes <= count; i += Lanes)
+		this->fillLanes(values + i);
+	// The tail still advances every lane, so the streams stay in step
+	if (i < count)
+	{
+		float rest[Lanes];
+		this->fillLanes(rest);
+		for (unsigned int lane = 0; i < count; ++i, ++lane)
+			values[i] = rest[lane];
+	}
+}
+
+void Random::fillLanes(float *values)
+{
+#if defined(RANDOM_SSE)
+	__m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i *>(this->lanes[0]));
+	__m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i *>(this->lanes[1]));
+	__m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i *>(this->lanes[2]));
+	__m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i *>(this->lanes[3]));
+	__m128i result = _mm_add_epi32(s0, s3);
+	__m128i t = _mm_slli_epi32(s1, 9);
+	s2 = _mm_xor_si128(s2, s0);
+	s3 = _mm_xor_si128(s3, s1);
+	s1 = _mm_xor_si128(s1, s2);
+	s0 = _mm_xor_si128(s0, s3);
+	s2 = _mm_xor_si128(s2, t);
+	s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+	_mm_store_si128(reinterpret_cast<__m128i *>(this->lanes[0]), s0);
+	_mm_store_si128(reinterpret_cast<__m128i *>(this->lanes[1]), s1);
+	_mm_store_si128(reinterpret_cast<__m128i *>(this->lanes[2]), s2);
+	_mm_store_si128(reinterpret_cast<__m128i *>(this->lanes[3]), s3);
+	// Below 2^24 the signed conversion is exact
+	__m128 floats = _mm_cvtepi32_ps(_mm_srli_epi32(result, 8));
+	_mm_storeu_ps(values, _mm_mul_ps(floats, _mm_set1_ps(FLOAT_UNIT)));
+#else
+	for (unsigned int lane = 0; lane < Lanes; ++lane)
+	{
+		uint32_t result = this->lanes[0][lane] + this->lanes[3][lane];
+		uint32_t t = this->lanes[1][lane] << 9;
+		this->lanes[2][lane] ^= this->lanes[0][lane];
+		this->lanes[3][lane] ^= this->lanes[1][lane];
+		this->lanes[1][lane] ^= this->lanes[2][lane];
+		this->lanes[0][lane] ^= this->lanes[3][lane];
+		this->lanes[2][lane] ^= t;
+		this->lanes[3][lane] = rotl(this->lanes[3][lane], 11);
+		values[lane] = (result >> 8) * FLOAT_UNIT;
+	}
+#endif
+}
@@ -0,0 +1,91 @@
+#include "RenderState.h"
+
+// Instantiate static variables
+RenderStateCounters RenderState::Counters = { 0, 0 };
+unsigned int RenderState::program = RenderState::UNKNOWN;
+unsigned int RenderState::activeUnit = RenderState::UNKNOWN;
+unsigned int RenderState::textures[RenderState::MAX_TEXTURE_UNITS] = {
+	UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+	UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN
+};
+unsigned int RenderState::vertexArray = RenderState::UNKNOWN;
+GLenum RenderState::blendSource = RenderState::UNKNOWN;
+GLenum RenderState::blendDestination = RenderState::UNKNOWN;
+
+RenderState::RenderState()
+{
+
+}
+
+void RenderState::UseProgram(unsigned int program)
+{
+	if (change(RenderState::program, program))
+		glUseProgram(program);
+}
+
+void RenderState::ActiveTexture(GLenum unit)
+{
+	if (change(activeUnit, unit))
+		glActiveTexture(unit);
+}
+
+void RenderState::BindTexture2D(unsigned int texture)
+{
+	// Without a known unit there's no shadow slot to compare against
+	unsigned int unit = activeUnit - GL_TEXTURE0;
+	if (activeUnit == UNKNOWN || unit >= MAX_TEXTURE_UNITS)
+	{
+		++Counters.Issued;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		return;
+	}
+	if (change(textures[unit], texture))
+		glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void RenderState::BindVertexArray(unsigned int vertexArray)
+{
+	if (change(RenderState::vertexArray, vertexArray))
+		glBindVertexArray(vertexArray);
+}
+
+void RenderState::BlendFunc(GLenum source, GLenum destination)
+{
+	if (source == blendSource && destination == blendDestination)
+	{
+		++Counters.Skipped;
+		return;
+	}
+	++Counters.Issued;
+	blendSource = source;
+	blendDestination = destination;
+	glBlendFunc(source, destination);
+}
+
+void RenderState::Invalidate()
+{
+	program = UNKNOWN;
+	activeUnit = UNKNOWN;
+	for (unsigned int &texture : textures)
+		texture = UNKNOWN;
+	vertexArray = UNKNOWN;
+	blendSource = UNKNOWN;
+	blendDestination = UNKNOWN;
+}
+
+void RenderState::ResetCounters()
+{
+	Counters = { 0, 0 };
+}
+
+bool RenderState::change(unsigned int &current, unsigned int value)
+{
+	if (current == value)
+	{
+		++Counters.Skipped;
+		return false;
+	}
+	++Counters.Issued;
+	current = value;
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// GL state changes made since the last RenderState::ResetCounters
+struct RenderStateCounters
+{
+	unsigned int Issued;  // Passed on to GL
+	unsigned int Skipped; // Dropped because the state was already current
+};
+
+// RenderState shadows the GL state the renderers change most often. Shader,
+// texture, vertex array and blend changes go through it and are only passed
+// on to GL if they differ from what is already current. Any code that
+// changes this state behind its back (or deletes a bound object) must call
+// Invalidate afterwards.
+class RenderState
+{
+public:
+	// Counts shared by all renderers
+	static RenderStateCounters Counters;
+	// Binds a shader program
+	static void UseProgram(unsigned int program);
+	// Selects the texture unit that BindTexture2D binds to, e.g. GL_TEXTURE0
+	static void ActiveTexture(GLenum unit);
+	// Binds a 2D texture to the active texture unit
+	static void BindTexture2D(unsigned int texture);
+	// Binds a vertex array object
+	static void BindVertexArray(unsigned int vertexArray);
+	// Sets the blend factors
+	static void BlendFunc(GLenum source, GLenum destination);
+	// Forgets all shadowed state, so the next change of each is issued
+	static void Invalidate();
+	// Starts counting state changes from zero, e.g. once per frame
+	static void ResetCounters();
+private:
+	// Texture units with shadowed bindings; units beyond are always issued
+	static const unsigned int MAX_TEXTURE_UNITS = 16;
+	// Marks shadowed state as unknown
+	static const unsigned int UNKNOWN = 0xFFFFFFFF;
+	// Shadowed state
+	static unsigned int program;
+	static unsigned int activeUnit;
+	static unsigned int textures[MAX_TEXTURE_UNITS];
+	static unsigned int vertexArray;
+	static GLenum blendSource, blendDestination;
+	// Private constructor, that is we do not want any actual render state objects. Its members and functions should be publicly available (static).
+	RenderState();
+	// Updates a shadowed value and the counters, true if the change needs to be issued
+	static bool change(unsigned int &current, unsigned int value);
+};
\ No newline at end of file
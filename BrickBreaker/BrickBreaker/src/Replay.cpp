@@ -0,0 +1,260 @@
+#include "Replay.h"
+
+#include <cstring>
+#include <iostream>
+
+// Identifies replay files and their layout
+const char REPLAY_MAGIC[4] = { 'B', 'B', 'R', 'P' };
+const uint32_t REPLAY_VERSION = 1;
+
+// Kinds of records following the header
+enum ReplayRecord : unsigned char
+{
+	RECORD_END = 0,
+	RECORD_INPUT = 1,     // Input byte, then the number of steps it was held for
+	RECORD_LEVEL = 2,     // Level switched to, then the level and player were reset
+	RECORD_CHECKPOINT = 3 // Number of steps run, then the state hash after them (8 bytes)
+};
+
+namespace
+{
+	// Unsigned LEB128: seven bits per byte, low bits first
+	void writeVarint(std::ofstream &out, unsigned long long value)
+	{
+		while (value >= 0x80)
+		{
+			out.put(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		out.put(static_cast<char>(value));
+	}
+
+	bool readVarint(const unsigned char *&data, const unsigned char *end, unsigned long long &value)
+	{
+		value = 0;
+		for (unsigned int shift = 0; data < end && shift < 64; shift += 7)
+		{
+			unsigned char byte = *data++;
+			value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	unsigned char currentInput(const Game &game)
+	{
+		unsigned char input = 0;
+		if (game.Keys[GLFW_KEY_A])
+			input |= INPUT_LEFT;
+		if (game.Keys[GLFW_KEY_D])
+			input |= INPUT_RIGHT;
+		if (game.Keys[GLFW_KEY_SPACE])
+			input |= INPUT_LAUNCH;
+		if (game.State != GAME_ACTIVE)
+			input |= INPUT_PAUSED;
+		return input;
+	}
+
+	void applyInput(Game &game, unsigned char input)
+	{
+		game.Keys[GLFW_KEY_A] = (input & INPUT_LEFT) != 0;
+		game.Keys[GLFW_KEY_D] = (input & INPUT_RIGHT) != 0;
+		game.Keys[GLFW_KEY_SPACE] = (input & INPUT_LAUNCH) != 0;
+		game.State = (input & INPUT_PAUSED) ? GAME_PAUSE : GAME_ACTIVE;
+	}
+}
+
+ReplayRecorder::ReplayRecorder()
+	: dt(0.0f), interval(0), steps(0), runInput(0), runLength(0)
+{
+
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+	this->End();
+}
+
+bool ReplayRecorder::Begin(const char *file, const Game &game, float dt, unsigned int checkpointInterval /*= REPLAY_CHECKPOINT_INTERVAL*/)
+{
+	this->End();
+	this->out.open(file, std::ios::binary | std::ios::trunc);
+	if (!this->out)
+		return false;
+	ReplayHeader header;
+	std::memcpy(header.Magic, REPLAY_MAGIC, 4);
+	header.Version = REPLAY_VERSION;
+	header.Width = game.Width;
+	header.Height = game.Height;
+	header.Level = game.Level;
+	header.BallCount = game.BallCount;
+	header.Seed = game.Seed;
+	header.Step = dt;
+	header.CheckpointInterval = checkpointInterval;
+	this->out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	this->dt = dt;
+	this->interval = checkpointInterval;
+	this->steps = 0;
+	this->runLength = 0;
+	return static_cast<bool>(this->out);
+}
+
+bool ReplayRecorder::IsRecording() const
+{
+	return this->out.is_open();
+}
+
+void ReplayRecorder::Step(Game &game)
+{
+	unsigned char input = currentInput(game);
+	if (this->runLength > 0 && input != this->runInput)
+		this->flushRun();
+	this->runInput = input;
+	++this->runLength;
+	game.Step(this->dt);
+	++this->steps;
+	if (this->interval > 0 && this->steps % this->interval == 0)
+	{
+		this->flushRun();
+		uint64_t hash = game.StateHash();
+		this->out.put(RECORD_CHECKPOINT);
+		writeVarint(this->out, this->steps);
+		this->out.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+	}
+}
+
+void ReplayRecorder::RecordLevel(unsigned int level)
+{
+	if (!this->IsRecording())
+		return;
+	this->flushRun();
+	this->out.put(RECORD_LEVEL);
+	writeVarint(this->out, level);
+}
+
+void ReplayRecorder::End()
+{
+	if (!this->IsRecording())
+		return;
+	this->flushRun();
+	this->out.put(RECORD_END);
+	this->out.close();
+}
+
+void ReplayRecorder::flushRun()
+{
+	if (this->runLength == 0)
+		return;
+	this->out.put(RECORD_INPUT);
+	this->out.put(static_cast<char>(this->runInput));
+	writeVarint(this->out, this->runLength);
+	this->runLength = 0;
+}
+
+Replay::Replay()
+	: Header(), Matched(0), Mismatched(0), FirstMismatch(0), Malformed(false)
+{
+
+}
+
+bool Replay::Open(const char *file)
+{
+	if (!this->file.Open(file) || this->file.Size < sizeof(ReplayHeader))
+	{
+		this->file.Close();
+		return false;
+	}
+	std::memcpy(&this->Header, this->file.Data, sizeof(ReplayHeader));
+	if (std::memcmp(this->Header.Magic, REPLAY_MAGIC, 4) != 0 || this->Header.Version != REPLAY_VERSION)
+	{
+		this->file.Close();
+		return false;
+	}
+	return true;
+}
+
+void Replay::Configure(Game &game) const
+{
+	game.BallCount = this->Header.BallCount;
+	game.Seed = this->Header.Seed;
+}
+
+unsigned long long Replay::Run(Game &game)
+{
+	this->Matched = this->Mismatched = 0;
+	this->FirstMismatch = 0;
+	this->Malformed = false;
+	if (this->Header.Level >= game.Levels.size())
+	{
+		std::cerr << "ERROR::REPLAY: Recording starts on level " << this->Header.Level + 1 << ", the game has " << game.Levels.size() << std::endl;
+		this->Malformed = true;
+		return 0;
+	}
+	game.Level = this->Header.Level;
+	game.ResetLevel();
+	game.ResetPlayer();
+	const unsigned char *data = this->file.Data + sizeof(ReplayHeader);
+	const unsigned char *end = this->file.Data + this->file.Size;
+	unsigned long long steps = 0;
+	// What's wrong with the stream, if anything; one that stops before its end record was cut off
+	const char *error = "Recording is truncated";
+	while (data < end)
+	{
+		unsigned char record = *data++;
+		unsigned long long value;
+		if (record == RECORD_END)
+		{
+			error = nullptr;
+			break;
+		}
+		else if (record == RECORD_INPUT)
+		{
+			if (data >= end)
+				break;
+			unsigned char input = *data++;
+			if (!readVarint(data, end, value))
+				break;
+			applyInput(game, input);
+			for (unsigned long long i = 0; i < value; ++i)
+				game.Step(this->Header.Step);
+			steps += value;
+		}
+		else if (record == RECORD_LEVEL)
+		{
+			if (!readVarint(data, end, value))
+				break;
+			if (value >= game.Levels.size())
+			{
+				error = "Level record out of range";
+				break;
+			}
+			game.Level = static_cast<unsigned int>(value);
+			game.ResetLevel();
+			game.ResetPlayer();
+		}
+		else if (record == RECORD_CHECKPOINT)
+		{
+			uint64_t expected;
+			if (!readVarint(data, end, value) || static_cast<size_t>(end - data) < sizeof(expected))
+				break;
+			std::memcpy(&expected, data, sizeof(expected));
+			data += sizeof(expected);
+			if (game.StateHash() == expected)
+				++this->Matched;
+			else if (this->Mismatched++ == 0)
+				this->FirstMismatch = value;
+		}
+		else
+		{
+			error = "Unknown record";
+			break;
+		}
+	}
+	if (error)
+	{
+		std::cerr << "ERROR::REPLAY: " << error << " after step " << steps << std::endl;
+		this->Malformed = true;
+	}
+	return steps;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+
+#include "Game.h"
+#include "MappedFile.h"
+
+// Input bits a simulation step ran with
+enum ReplayInput : unsigned char
+{
+	INPUT_LEFT = 1 << 0,   // A held
+	INPUT_RIGHT = 1 << 1,  // D held
+	INPUT_LAUNCH = 1 << 2, // Space held
+	INPUT_PAUSED = 1 << 3  // Game not active, the step only advanced time
+};
+
+// Replay file header, followed by a stream of records
+struct ReplayHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t Width, Height; // Playfield size
+	uint32_t Level;         // Level the recording starts on
+	uint32_t BallCount;     // Balls served after every reset
+	uint32_t Seed;          // Game::Seed
+	float Step;             // Length of every step in seconds
+	uint32_t CheckpointInterval;
+};
+
+// Steps between state hash checkpoints unless asked otherwise
+const unsigned int REPLAY_CHECKPOINT_INTERVAL = 600;
+
+// ReplayRecorder logs everything a session's simulation depends on: the
+// setup in the header, then per step the input as a bitmask, run-length
+// encoded since input rarely changes between steps, level changes, and a
+// hash of the game state every CheckpointInterval steps so replays can be
+// checked against the original.
+class ReplayRecorder
+{
+public:
+	ReplayRecorder();
+	~ReplayRecorder();
+	ReplayRecorder(const ReplayRecorder &) = delete;
+	ReplayRecorder &operator=(const ReplayRecorder &) = delete;
+	// Starts recording game, which must have just been initialized or had its level and player
+	// reset; every step then has to go through Step. False if the file can't be written.
+	bool Begin(const char *file, const Game &game, float dt, unsigned int checkpointInterval = REPLAY_CHECKPOINT_INTERVAL);
+	bool IsRecording() const;
+	// Records the input game is about to step with, then steps it
+	void Step(Game &game);
+	// Records that the level was switched to and the level and player reset
+	void RecordLevel(unsigned int level);
+	// Finishes the recording
+	void End();
+private:
+	std::ofstream out;
+	float dt;
+	unsigned int interval;
+	unsigned long long steps;
+	// Input of the steps not written yet, all the same
+	unsigned char runInput;
+	unsigned long long runLength;
+	// Writes the pending run of input
+	void flushRun();
+};
+
+// Replay reads a recording and feeds it through a game as fast as the CPU
+// allows, comparing the state hash at every checkpoint.
+class Replay
+{
+public:
+	ReplayHeader Header;
+	// Checkpoints passed and failed by Run
+	unsigned int Matched, Mismatched;
+	// Step of the first failed checkpoint
+	unsigned long long FirstMismatch;
+	// Whether Run stopped on a broken or cut off record stream, or a level the game doesn't have
+	bool Malformed;
+
+	Replay();
+	// Maps a recording and reads its header; false if it's missing or malformed
+	bool Open(const char *file);
+	// Sets up game like the recorded one; call before game.Init
+	void Configure(Game &game) const;
+	// Plays the recording on an initialized game, reporting a malformed one; returns the number of steps run
+	unsigned long long Run(Game &game);
+private:
+	MappedFile file;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A typed reference to a resource stored in ResourceSlots: the index of its
+// slot and the generation the slot had when the resource was stored. Slots
+// move to a new generation when their resource is removed, so a handle that
+// outlives its resource is detected instead of silently referring to whatever
+// reuses the slot. Live slots never have generation 0, which makes a default
+// constructed handle invalid.
+template <typename T>
+struct ResourceHandle
+{
+	unsigned int Index;
+	unsigned int Generation;
+
+	constexpr ResourceHandle() : Index(0), Generation(0) { }
+	constexpr ResourceHandle(unsigned int index, unsigned int generation) : Index(index), Generation(generation) { }
+	// Whether the handle was ever returned for a stored resource
+	constexpr bool IsValid() const { return this->Generation != 0; }
+	constexpr bool operator==(const ResourceHandle &other) const { return this->Index == other.Index && this->Generation == other.Generation; }
+	constexpr bool operator!=(const ResourceHandle &other) const { return !(*this == other); }
+};
+
+class Texture2D;
+class Shader;
+typedef ResourceHandle<Texture2D> TextureHandle;
+typedef ResourceHandle<Shader> ShaderHandle;
+
+// Dense slot array of resources addressed by ResourceHandle. Names are only
+// looked up when a handle is made; resolving a handle is an index and a
+// generation compare.
+template <typename T>
+class ResourceSlots
+{
+public:
+	// Stores a resource under name, replacing the one stored under it before. Handles
+	// to a replaced resource stay valid and refer to the new one.
+	ResourceHandle<T> Store(const std::string &name, const T &resource)
+	{
+		auto named = this->names.find(name);
+		if (named != this->names.end())
+		{
+			Slot &slot = this->slots[named->second];
+			slot.Resource = resource;
+			return ResourceHandle<T>(named->second, slot.Generation);
+		}
+		unsigned int index;
+		if (!this->free.empty())
+		{
+			index = this->free.back();
+			this->free.pop_back();
+		}
+		else
+		{
+			index = static_cast<unsigned int>(this->slots.size());
+			this->slots.push_back(Slot());
+		}
+		Slot &slot = this->slots[index];
+		slot.Resource = resource;
+		slot.Name = name;
+		slot.Live = true;
+		this->names[name] = index;
+		return ResourceHandle<T>(index, slot.Generation);
+	}
+	// Returns the handle of the resource stored under name, or an invalid handle
+	ResourceHandle<T> Find(const std::string &name) const
+	{
+		auto named = this->names.find(name);
+		if (named == this->names.end())
+			return ResourceHandle<T>();
+		return ResourceHandle<T>(named->second, this->slots[named->second].Generation);
+	}
+	// Returns the resource a handle refers to, or nullptr if it was removed or the handle is invalid
+	T *Get(ResourceHandle<T> handle)
+	{
+		if (handle.Index >= this->slots.size() || this->slots[handle.Index].Generation != handle.Generation || !this->slots[handle.Index].Live)
+			return nullptr;
+		return &this->slots[handle.Index].Resource;
+	}
+	// Calls function with every stored resource
+	template <typename Function>
+	void ForEach(Function function)
+	{
+		for (Slot &slot : this->slots)
+			if (slot.Live)
+				function(slot.Resource);
+	}
+	// Removes all resources; the slots are kept so handles to them are recognized as stale
+	void Clear()
+	{
+		for (unsigned int i = 0; i < this->slots.size(); ++i)
+			if (this->slots[i].Live)
+				this->release(i);
+	}
+private:
+	struct Slot
+	{
+		T Resource;
+		std::string Name;
+		unsigned int Generation = 1;
+		bool Live = false;
+	};
+	std::vector<Slot> slots;
+	std::vector<unsigned int> free;
+	std::unordered_map<std::string, unsigned int> names;
+	// Frees a live slot and moves it to its next generation, skipping 0
+	void release(unsigned int index)
+	{
+		Slot &slot = this->slots[index];
+		this->names.erase(slot.Name);
+		slot.Resource = T();
+		slot.Name.clear();
+		slot.Live = false;
+		if (++slot.Generation == 0)
+			slot.Generation = 1;
+		this->free.push_back(index);
+	}
+};
@@ -0,0 +1,46 @@
+#include "ResourceLoader.h"
+
+ResourceLoader::ResourceLoader(unsigned int threads /*= 2*/)
+	: quit(false)
+{
+	for (unsigned int i = 0; i < threads; ++i)
+		this->threads.emplace_back(&ResourceLoader::workerLoop, this);
+}
+
+ResourceLoader::~ResourceLoader()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->quit = true;
+	}
+	this->wake.notify_all();
+	// Queued tasks are finished first, so no future is left without a result
+	for (std::thread &thread : this->threads)
+		thread.join();
+}
+
+void ResourceLoader::push(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->tasks.push_back(std::move(task));
+	}
+	this->wake.notify_one();
+}
+
+void ResourceLoader::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> wait(this->lock);
+			this->wake.wait(wait, [this] { return this->quit || !this->tasks.empty(); });
+			if (this->tasks.empty())
+				return;
+			task = std::move(this->tasks.front());
+			this->tasks.pop_front();
+		}
+		task();
+	}
+}
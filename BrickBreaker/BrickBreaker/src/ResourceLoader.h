@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ResourceLoader runs loading work (file reads, image decoding, parsing) on
+// background threads. Submit queues a task and returns a future for its
+// result right away; tasks start in submission order. Nothing here touches
+// GL, so results that need uploading are handed back to the main thread.
+class ResourceLoader
+{
+public:
+	ResourceLoader(unsigned int threads = 2);
+	~ResourceLoader();
+	// Queues a task and returns the future of its result
+	template <typename Task>
+	std::future<decltype(std::declval<Task>()())> Submit(Task task)
+	{
+		typedef decltype(task()) Result;
+		std::shared_ptr<std::packaged_task<Result()>> packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+		std::future<Result> future = packaged->get_future();
+		this->push([packaged] { (*packaged)(); });
+		return future;
+	}
+private:
+	std::vector<std::thread> threads;
+	std::deque<std::function<void()>> tasks;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool quit;
+	// Adds a task to the queue
+	void push(std::function<void()> task);
+	// Runs tasks until the loader is destroyed
+	void workerLoop();
+};
\ No newline at end of file
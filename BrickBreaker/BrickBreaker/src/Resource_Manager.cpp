@@ -1,5 +1,9 @@
 #include "Resource_Manager.h"
+#include "RenderState.h"
+#include "GameLevel.h"
 
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -8,40 +12,260 @@
 #include <stb_image.h>
 
 // Instantiate static variables
-std::map<std::string, Shader> ResourceManager::Shaders;
+unsigned int ResourceManager::Misses = 0;
 
-std::map<std::string, Texture2D> ResourceManager::Textures;
+unsigned int ResourceManager::StaleHandles = 0;
 
-Shader ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name)
+std::unordered_set<std::string> ResourceManager::reported;
+
+ResourceSlots<Shader> ResourceManager::shaders;
+
+ResourceSlots<Texture2D> ResourceManager::textures;
+
+Shader ResourceManager::missingShader;
+
+Texture2D ResourceManager::missingTexture;
+
+AssetPack ResourceManager::Pack;
+
+std::unique_ptr<ResourceLoader> ResourceManager::loader;
+
+std::vector<ResourceManager::PendingUpload> ResourceManager::uploads;
+
+unsigned int ResourceManager::uploadBuffer = 0;
+
+// Threads decoding and parsing in the background
+const unsigned int LOADER_THREADS = 2;
+
+bool ResourceManager::OpenPack(const char *file)
+{
+	return Pack.Open(file);
+}
+
+ShaderHandle ResourceManager::LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &name)
+{
+	return shaders.Store(name, loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile));
+}
+
+ShaderHandle ResourceManager::FindShader(const std::string &name)
+{
+	ShaderHandle handle = shaders.Find(name);
+	if (!handle.IsValid())
+	{
+		++Misses;
+		reportMiss("No shader named " + name);
+	}
+	return handle;
+}
+
+Shader &ResourceManager::GetShader(ShaderHandle handle)
+{
+	Shader *shader = shaders.Get(handle);
+	if (shader)
+		return *shader;
+	// Handles that were never resolved were counted by FindShader already
+	if (handle.IsValid())
+		reportStale("shader", handle);
+	return missingShader;
+}
+
+Shader &ResourceManager::GetShader(const std::string &name)
+{
+	return GetShader(FindShader(name));
+}
+
+TextureHandle ResourceManager::LoadTexture(const char *file, bool alpha, const std::string &name)
+{
+	return textures.Store(name, loadTextureFromFile(file, alpha));
+}
+
+TextureHandle ResourceManager::FindTexture(const std::string &name)
+{
+	TextureHandle handle = textures.Find(name);
+	if (!handle.IsValid())
+	{
+		++Misses;
+		reportMiss("No texture named " + name);
+	}
+	return handle;
+}
+
+const Texture2D &ResourceManager::GetTexture(TextureHandle handle)
+{
+	const Texture2D *texture = textures.Get(handle);
+	if (texture)
+		return *texture;
+	// Handles that were never resolved were counted by FindTexture already
+	if (handle.IsValid())
+		reportStale("texture", handle);
+	return missingTexture;
+}
+
+const Texture2D &ResourceManager::GetTexture(const std::string &name)
+{
+	return GetTexture(FindTexture(name));
+}
+
+void ResourceManager::LoadTextureAtlas(const std::vector<AtlasSource> &sources, const char *cacheFile, unsigned int pageSize /*= 2048*/)
+{
+	TextureAtlas atlas(pageSize);
+	if (!atlas.Load(cacheFile, sources))
+	{
+		if (!atlas.Build(sources, &Pack))
+		{
+			// Fall back to one texture per image
+			for (const AtlasSource &source : sources)
+				LoadTexture(source.File.c_str(), source.Alpha, source.Name);
+			return;
+		}
+		if (!atlas.Save(cacheFile, sources))
+			std::cerr << "ERROR::ATLAS: Failed to write atlas cache: " << cacheFile << std::endl;
+	}
+	// One texture object per page
+	std::vector<Texture2D> pages(atlas.Pages.size());
+	for (unsigned int i = 0; i < atlas.Pages.size(); ++i)
+	{
+		pages[i].Internal_Format = GL_RGBA;
+		pages[i].Image_Format = GL_RGBA;
+		pages[i].Generate(atlas.Pages[i].Width, atlas.Pages[i].Height, atlas.Pages[i].Pixels.data());
+	}
+	// Every image shares its page's texture object and covers only its own region of it
+	for (unsigned int i = 0; i < sources.size(); ++i)
+	{
+		const AtlasRegion &region = atlas.Regions[i];
+		Texture2D texture = pages[region.Page];
+		glm::vec2 pageSize(texture.Width, texture.Height);
+		texture.Region = glm::vec4(glm::vec2(region.X, region.Y) / pageSize, glm::vec2(region.Width, region.Height) / pageSize);
+		texture.Width = region.Width;
+		texture.Height = region.Height;
+		textures.Store(sources[i].Name, texture);
+	}
+}
+
+TextureHandle ResourceManager::LoadTextureAsync(const char *file, bool alpha, const std::string &name)
 {
-	Shaders[name] = loadShaderFromFile(vShaderFile, fShaderFile, gShaderFile);
-	return Shaders[name];
+	Texture2D texture;
+	if (alpha)
+	{
+		texture.Internal_Format = GL_RGBA;
+		texture.Image_Format = GL_RGBA;
+	}
+	// A single grey texel stands in until the real pixels arrive
+	const unsigned char placeholder[4] = { 96, 96, 96, 255 };
+	texture.Generate(1, 1, placeholder);
+	TextureHandle handle = textures.Store(name, texture);
+	std::string path = file;
+	int channels = alpha ? 4 : 3;
+	PendingUpload upload;
+	upload.Texture = handle;
+	upload.File = path;
+	upload.Image = getLoader().Submit([path, channels]()
+	{
+		DecodedImage image = { nullptr, nullptr, 0, 0, channels };
+		// Cooked pixels need no decoding at all
+		const PackEntry *cooked = Pack.Find(path, PACK_TEXTURE);
+		if (cooked && cooked->Channels == static_cast<unsigned int>(channels))
+		{
+			image.Pixels = Pack.Data(*cooked);
+			image.Width = cooked->Width;
+			image.Height = cooked->Height;
+			return image;
+		}
+		int fileChannels;
+		image.Owned = stbi_load(path.c_str(), &image.Width, &image.Height, &fileChannels, channels);
+		image.Pixels = image.Owned;
+		return image;
+	});
+	uploads.push_back(std::move(upload));
+	return handle;
 }
 
-Shader ResourceManager::GetShader(std::string name)
+std::future<GameLevel> ResourceManager::LoadLevelAsync(const char *file, unsigned int levelWidth, unsigned int levelHeight)
 {
-	return Shaders[name];
+	std::string path = file;
+	return getLoader().Submit([path, levelWidth, levelHeight]()
+	{
+		// Load only reads the pack, which doesn't change while levels load
+		GameLevel level;
+		level.Load(path.c_str(), levelWidth, levelHeight);
+		return level;
+	});
 }
 
-Texture2D ResourceManager::LoadTexture(const char *file, bool alpha, std::string name)
+unsigned int ResourceManager::ProcessUploads(unsigned int maxUploads)
 {
-	Textures[name] = loadTextureFromFile(file, alpha);
-	return Textures[name];
+	unsigned int uploaded = 0;
+	auto it = uploads.begin();
+	while (it != uploads.end() && uploaded < maxUploads)
+	{
+		// Uploads that aren't decoded yet don't hold up the ones behind them
+		if (it->Image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			++it;
+			continue;
+		}
+		DecodedImage image = it->Image.get();
+		Texture2D *texture = textures.Get(it->Texture);
+		if (!texture)
+			reportStale("texture", it->Texture);
+		else if (!image.Pixels)
+			std::cerr << "ERROR::TEXTURE: Failed to load texture file: " << it->File << std::endl;
+		else
+		{
+			size_t size = static_cast<size_t>(image.Width) * image.Height * image.Channels;
+			if (uploadBuffer == 0)
+				glGenBuffers(1, &uploadBuffer);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+			// Orphan the last upload's storage so the copy doesn't wait for the driver to finish with it
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+			void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+			if (mapped)
+			{
+				std::memcpy(mapped, image.Pixels, size);
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			}
+			else
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			// Rows of RGB images aren't always a multiple of four bytes
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			// With the buffer bound the data pointer is an offset into it
+			texture->Generate(image.Width, image.Height, mapped ? nullptr : image.Pixels);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		stbi_image_free(image.Owned);
+		it = uploads.erase(it);
+		++uploaded;
+	}
+	return static_cast<unsigned int>(uploads.size());
 }
 
-Texture2D ResourceManager::GetTexture(std::string name)
+ResourceLoader &ResourceManager::getLoader()
 {
-	return Textures[name];
+	if (!loader)
+		loader = std::make_unique<ResourceLoader>(LOADER_THREADS);
+	return *loader;
 }
 
 void ResourceManager::Clear()
 {
+	// Let background work finish before the pack it may read from goes away
+	loader.reset();
+	for (PendingUpload &upload : uploads)
+		stbi_image_free(upload.Image.get().Owned);
+	uploads.clear();
+	if (uploadBuffer != 0)
+		glDeleteBuffers(1, &uploadBuffer);
+	uploadBuffer = 0;
 	// Properly delete all shaders
-	for (auto iter : Shaders)
-		glDeleteProgram(iter.second.ID);
+	shaders.ForEach([](Shader &shader) { glDeleteProgram(shader.ID); });
+	shaders.Clear();
 	// Properly delete all textures
-	for (auto iter : Textures)
-		glDeleteTextures(1, &iter.second.ID);
+	textures.ForEach([](Texture2D &texture) { glDeleteTextures(1, &texture.ID); });
+	textures.Clear();
+	Pack.Close();
+	// Deleting bound objects resets their bindings
+	RenderState::Invalidate();
 }
 
 ResourceManager::ResourceManager()
@@ -49,8 +273,32 @@ ResourceManager::ResourceManager()
 
 }
 
+void ResourceManager::reportMiss(const std::string &what)
+{
+	if (reported.insert(what).second)
+		std::cerr << "ERROR::RESOURCE: " << what << std::endl;
+}
+
+template <typename T>
+void ResourceManager::reportStale(const char *kind, ResourceHandle<T> handle)
+{
+	++StaleHandles;
+	reportMiss("Stale " + std::string(kind) + " handle " + std::to_string(handle.Index) + ":" + std::to_string(handle.Generation));
+}
+
 Shader ResourceManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile /*= nullptr*/)
 {
+	// Cooked sources are used straight from the pack
+	const PackEntry *vertexEntry = Pack.Find(vShaderFile, PACK_TEXT);
+	const PackEntry *fragmentEntry = Pack.Find(fShaderFile, PACK_TEXT);
+	const PackEntry *geometryEntry = gShaderFile != nullptr ? Pack.Find(gShaderFile, PACK_TEXT) : nullptr;
+	if (vertexEntry && fragmentEntry && (gShaderFile == nullptr || geometryEntry))
+	{
+		Shader shader;
+		shader.Compile(reinterpret_cast<const char *>(Pack.Data(*vertexEntry)), reinterpret_cast<const char *>(Pack.Data(*fragmentEntry)),
+			geometryEntry ? reinterpret_cast<const char *>(Pack.Data(*geometryEntry)) : nullptr);
+		return shader;
+	}
 	// 1. Retrieve the vertex/fragment source code from filePath
 	std::string vertexCode;
 	std::string fragmentCode;
@@ -114,6 +362,13 @@ Texture2D ResourceManager::loadTextureFromFile(const char* file, bool alpha)
 		texture.Internal_Format = GL_RGBA;
 		texture.Image_Format = GL_RGBA;
 	}
+	// Cooked pixels are uploaded straight from the pack, if they have the expected channels
+	const PackEntry *cooked = Pack.Find(file, PACK_TEXTURE);
+	if (cooked && cooked->Channels == (alpha ? 4u : 3u))
+	{
+		texture.Generate(cooked->Width, cooked->Height, Pack.Data(*cooked));
+		return texture;
+	}
 	// Load image
 	int width, height, nrChannels;
 	unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
@@ -1,37 +1,111 @@
 #pragma once
 
-#include <map>
+#include <future>
+#include <memory>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "Texture.h"
 #include "Shader.h"
+#include "TextureAtlas.h"
+#include "AssetPack.h"
+#include "ResourceLoader.h"
+#include "ResourceHandle.h"
+
+class GameLevel;
 
 // A static singleton ResourceManager class that hosts several
 // functions to load Textures and Shaders. Each loaded texture
-// and/or shader is also stored for future reference by string
-// handles. All functions and resources are static and no 
-// public constructor is defined.
+// and/or shader is stored in a slot array and referred to by a
+// typed handle; names are only looked up when a handle is made,
+// so resolve handles once at load time. Lookups that find nothing
+// are counted in Misses instead of creating resources and stale
+// handles in StaleHandles; each missing name and each stale handle
+// is printed the first time it's hit. Files found in the open asset pack are taken from it
+// instead of disk. Textures and levels can also be loaded in the
+// background; textures then show a placeholder until ProcessUploads
+// has uploaded their pixels. All functions and resources are static
+// and no public constructor is defined.
 class ResourceManager
 {
 public:
-	// Resource storage
-	static std::map<std::string, Shader> Shaders;
-	static std::map<std::string, Texture2D> Textures;
+	// Number of name lookups that found no resource
+	static unsigned int Misses;
+	// Number of times a handle to a removed resource was used
+	static unsigned int StaleHandles;
+	// Cooked assets, used in place of the files they were cooked from while open
+	static AssetPack Pack;
+	// Opens an asset pack written by the asset cooker; false if there is none
+	static bool OpenPack(const char *file);
 	// loads (and generates) a shader program from file loading vertex, fragment (and geometry) shader source code. If gShaderFile is not nullptr, it also loads a geometry shader
-	static Shader LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
-	// Retrieves a stored shader
-	static Shader GetShader(std::string name);
+	static ShaderHandle LoadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, const std::string &name);
+	// Returns the handle of a stored shader, or an invalid handle if there is none
+	static ShaderHandle FindShader(const std::string &name);
+	// Retrieves a stored shader; stale handles give an empty shader
+	static Shader &GetShader(ShaderHandle handle);
+	// Retrieves a stored shader by name, for code that runs once
+	static Shader &GetShader(const std::string &name);
 	// Loads (and generates) a texture from file
-	static Texture2D LoadTexture(const char *file, bool alpha, std::string name);
-	// Retrieves a stored texture
-	static Texture2D GetTexture(std::string name);
+	static TextureHandle LoadTexture(const char *file, bool alpha, const std::string &name);
+	// Returns the handle of a stored texture, or an invalid handle if there is none
+	static TextureHandle FindTexture(const std::string &name);
+	// Retrieves a stored texture; stale handles give an empty texture
+	static const Texture2D &GetTexture(TextureHandle handle);
+	// Retrieves a stored texture by name, for code that runs once
+	static const Texture2D &GetTexture(const std::string &name);
+	// Loads textures packed into shared atlas pages and stores each by its source name; the
+	// packed atlas is cached in cacheFile and reused for as long as the sources don't change
+	static void LoadTextureAtlas(const std::vector<AtlasSource> &sources, const char *cacheFile, unsigned int pageSize = 2048);
+	// Starts decoding a texture in the background and stores it right away. It shows a placeholder
+	// until ProcessUploads uploads its pixels into the same texture object, so copies taken
+	// before then update as well (except for their Width and Height).
+	static TextureHandle LoadTextureAsync(const char *file, bool alpha, const std::string &name);
+	// Starts loading a level in the background, parsed straight into its brick arrays for a
+	// levelWidth x levelHeight area; call ResolveSprites on it once it's ready
+	static std::future<GameLevel> LoadLevelAsync(const char *file, unsigned int levelWidth, unsigned int levelHeight);
+	// Uploads up to maxUploads textures whose pixels are ready through a pixel buffer object; call
+	// once per frame on the GL thread. Returns the number of uploads still pending.
+	static unsigned int ProcessUploads(unsigned int maxUploads);
 	// Properly de-allocates all loaded resources
 	static void Clear();
 private:
 	// Private constructor, that is we do not want any actual resource manager objects. Its members and functions should be publicly available (static).
 	ResourceManager();
+	// Resource storage
+	static ResourceSlots<Shader> shaders;
+	static ResourceSlots<Texture2D> textures;
+	// Returned for lookups that find nothing; they own no GL objects
+	static Shader missingShader;
+	static Texture2D missingTexture;
+	// Misses and stale handles already printed; they're only printed once since hot paths repeat them every frame
+	static std::unordered_set<std::string> reported;
+	// Prints what the first time it's reported
+	static void reportMiss(const std::string &what);
+	// Counts and reports the use of a stale handle
+	template <typename T>
+	static void reportStale(const char *kind, ResourceHandle<T> handle);
 	// Loads and generates a shader from file
 	static Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile = nullptr);
 	// Loads a single texture from file
 	static Texture2D loadTextureFromFile(const char *file, bool alpha);
+	// Pixels of a texture decoded in the background; Owned is set if they need freeing
+	struct DecodedImage
+	{
+		const unsigned char *Pixels;
+		unsigned char *Owned;
+		int Width, Height, Channels;
+	};
+	// A texture waiting for its pixels
+	struct PendingUpload
+	{
+		TextureHandle Texture;
+		std::string File;
+		std::future<DecodedImage> Image;
+	};
+	// Background loading state, created with the first asynchronous load
+	static std::unique_ptr<ResourceLoader> loader;
+	static std::vector<PendingUpload> uploads;
+	static unsigned int uploadBuffer;
+	static ResourceLoader &getLoader();
 };
\ No newline at end of file
@@ -1,10 +1,64 @@
 #include "Shader.h"
+#include "RenderState.h"
 
 #include <iostream>
+#include <vector>
+
+// Open addressing hash table keyed by uniform name hash. A program has a
+// handful of uniforms, so the table is tiny and probes rarely go past the
+// first slot.
+class UniformTable
+{
+public:
+	UniformTable(unsigned int count)
+	{
+		// Keep the load factor at or below one half
+		unsigned int capacity = 4;
+		while (capacity < count * 2)
+			capacity *= 2;
+		this->slots.assign(capacity, { 0, -1 });
+		this->mask = capacity - 1;
+	}
+	// Adds a uniform, false if another one has the same hash
+	bool Insert(unsigned int hash, int location)
+	{
+		unsigned int i = hash & this->mask;
+		while (this->slots[i].Location >= 0)
+		{
+			if (this->slots[i].Hash == hash)
+				return this->slots[i].Location == location;
+			i = (i + 1) & this->mask;
+		}
+		this->slots[i] = { hash, location };
+		return true;
+	}
+	int Find(unsigned int hash) const
+	{
+		unsigned int i = hash & this->mask;
+		while (this->slots[i].Location >= 0)
+		{
+			if (this->slots[i].Hash == hash)
+				return this->slots[i].Location;
+			i = (i + 1) & this->mask;
+		}
+		return -1;
+	}
+private:
+	// An empty slot has a negative location
+	struct Slot
+	{
+		unsigned int Hash;
+		int Location;
+	};
+	std::vector<Slot> slots;
+	unsigned int mask;
+};
+
+UniformCounters Shader::Counters = { 0, 0 };
 
 Shader& Shader::Use()
 {
-	glUseProgram(this->ID);
+	RenderState::UseProgram(this->ID);
 	return *this;
 }
 
@@ -43,6 +97,7 @@ void Shader::Compile(const char* vertexSource, const char* fragmentSource, const
 	}
 	glLinkProgram(this->ID);
 	checkCompileErrors(this->ID, "PROGRAM");
+	this->reflectUniforms();
 	// Delete the shaders as they're linked into our program now and no longer necessary
 	glDeleteShader(sVertex);
 	glDeleteShader(sFragment);
@@ -52,67 +107,122 @@ void Shader::Compile(const char* vertexSource, const char* fragmentSource, const
 	}
 }
 
-void Shader::SetFloat(const char *name, float value, bool useShader /*= false*/)
+void Shader::SetFloat(UniformHandle name, float value, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform1f(glGetUniformLocation(this->ID, name), value);
+	glUniform1f(this->GetUniformLocation(name), value);
 }
 
-void Shader::SetInteger(const char *name, float value, bool useShader /*= false*/)
+void Shader::SetInteger(UniformHandle name, float value, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform1i(glGetUniformLocation(this->ID, name), value);
+	glUniform1i(this->GetUniformLocation(name), value);
 }
 
-void Shader::SetVector2f(const char *name, float x, float y, bool useShader /*= false*/)
+void Shader::SetVector2f(UniformHandle name, float x, float y, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+	glUniform2f(this->GetUniformLocation(name), x, y);
 }
 
-void Shader::SetVector2f(const char *name, const glm::vec2& value, bool useShader /*= false*/)
+void Shader::SetVector2f(UniformHandle name, const glm::vec2& value, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+	glUniform2f(this->GetUniformLocation(name), value.x, value.y);
 }
 
-void Shader::SetVector3f(const char *name, float x, float y, float z, bool useShader /*= false*/)
+void Shader::SetVector3f(UniformHandle name, float x, float y, float z, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+	glUniform3f(this->GetUniformLocation(name), x, y, z);
 }
 
-void Shader::SetVector3f(const char *name, const glm::vec3& value, bool useShader /*= false*/)
+void Shader::SetVector3f(UniformHandle name, const glm::vec3& value, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+	glUniform3f(this->GetUniformLocation(name), value.x, value.y, value.z);
 }
 
-void Shader::SetVector4f(const char *name, float x, float y, float z, float w, bool useShader /*= false*/)
+void Shader::SetVector4f(UniformHandle name, float x, float y, float z, float w, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+	glUniform4f(this->GetUniformLocation(name), x, y, z, w);
 }
 
-void Shader::SetVector4f(const char *name, const glm::vec4& value, bool useShader /*= false*/)
+void Shader::SetVector4f(UniformHandle name, const glm::vec4& value, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+	glUniform4f(this->GetUniformLocation(name), value.x, value.y, value.z, value.w);
 }
 
-void Shader::SetMatrix4(const char *name, const glm::mat4 &matrix, bool useShader /*= false*/)
+void Shader::SetMatrix4(UniformHandle name, const glm::mat4 &matrix, bool useShader /*= false*/)
 {
 	if (useShader)
 		this->Use();
-	glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+	glUniformMatrix4fv(this->GetUniformLocation(name), 1, false, glm::value_ptr(matrix));
+}
+
+int Shader::GetUniformLocation(UniformHandle name) const
+{
+	int location = this->uniforms ? this->uniforms->Find(name.Hash) : -1;
+	if (location >= 0)
+		++Counters.CachedLookups;
+	else
+		++Counters.Misses;
+	return location;
+}
+
+void Shader::ResetCounters()
+{
+	Counters = { 0, 0 };
+}
+
+void Shader::reflectUniforms()
+{
+	int count = 0, maxLength = 0;
+	glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	// Collect every name a uniform can be set by
+	std::vector<std::pair<std::string, int>> names;
+	std::vector<char> buffer(maxLength + 1);
+	for (int i = 0; i < count; ++i)
+	{
+		int length = 0, size = 0;
+		GLenum type;
+		glGetActiveUniform(this->ID, i, maxLength + 1, &length, &size, &type, buffer.data());
+		std::string name(buffer.data(), length);
+		int location = glGetUniformLocation(this->ID, name.c_str());
+		// Members of uniform blocks have no location
+		if (location < 0)
+			continue;
+		names.push_back({ name, location });
+		// Arrays are reported as "name[0]"; make "name" and every element reachable as well
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+		{
+			std::string base = name.substr(0, name.size() - 3);
+			names.push_back({ base, location });
+			for (int element = 1; element < size; ++element)
+			{
+				std::string elementName = base + "[" + std::to_string(element) + "]";
+				names.push_back({ elementName, glGetUniformLocation(this->ID, elementName.c_str()) });
+			}
+		}
+	}
+	std::shared_ptr<UniformTable> table = std::make_shared<UniformTable>(static_cast<unsigned int>(names.size()));
+	for (const std::pair<std::string, int> &uniform : names)
+	{
+		if (uniform.second >= 0 && !table->Insert(HashUniformName(uniform.first.c_str()), uniform.second))
+			std::cout << "| ERROR::SHADER: Uniform name hash collision: " << uniform.first << std::endl;
+	}
+	this->uniforms = table;
 }
 
 void Shader::checkCompileErrors(unsigned int object, std::string type)
@@ -1,33 +1,72 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+// FNV-1a hash of a uniform name, usable at compile time
+constexpr unsigned int HashUniformName(const char *name)
+{
+	unsigned int hash = 2166136261u;
+	for (; *name; ++name)
+		hash = (hash ^ static_cast<unsigned char>(*name)) * 16777619u;
+	return hash;
+}
+
+// Identifies a uniform by the hash of its name. Strings convert implicitly;
+// declaring a handle constexpr moves the hashing to compile time, so setting
+// the uniform costs a single table probe.
+struct UniformHandle
+{
+	unsigned int Hash;
+	constexpr UniformHandle(const char *name) : Hash(HashUniformName(name)) { }
+};
+
+// Uniform lookups made since the last Shader::ResetCounters
+struct UniformCounters
+{
+	unsigned int CachedLookups; // Served from a reflected table instead of glGetUniformLocation
+	unsigned int Misses;        // Not in the table: inactive, optimized out or misspelled
+};
+
+// Name to location table of a program's active uniforms
+class UniformTable;
+
 class Shader
 {
 public:
 	// State
 	unsigned int ID;
+	// Lookup counts shared by all shaders
+	static UniformCounters Counters;
 	// Constructor
-	Shader() { }
+	Shader() : ID(0) { }
 	// Sets the current shader as active
 	Shader& Use();
 	// Compiles the shader from given source code
 	void Compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource = nullptr);
 	// Utility functions
-	void SetFloat(const char *name, float value, bool useShader = false);
-	void SetInteger(const char *name, float value, bool useShader = false);
-	void SetVector2f(const char *name, float x, float y, bool useShader = false);
-	void SetVector2f(const char *name, const glm::vec2 &value, bool useShader = false);
-	void SetVector3f(const char *name, float x, float y, float z, bool useShader = false);
-	void SetVector3f(const char *name, const glm::vec3 &value, bool useShader = false);
-	void SetVector4f(const char *name, float x, float y, float z, float w, bool useShader = false);
-	void SetVector4f(const char *name, const glm::vec4 &value, bool useShader = false);
-	void SetMatrix4(const char *name, const glm::mat4 &matrix, bool useShader = false);
+	void SetFloat(UniformHandle name, float value, bool useShader = false);
+	void SetInteger(UniformHandle name, float value, bool useShader = false);
+	void SetVector2f(UniformHandle name, float x, float y, bool useShader = false);
+	void SetVector2f(UniformHandle name, const glm::vec2 &value, bool useShader = false);
+	void SetVector3f(UniformHandle name, float x, float y, float z, bool useShader = false);
+	void SetVector3f(UniformHandle name, const glm::vec3 &value, bool useShader = false);
+	void SetVector4f(UniformHandle name, float x, float y, float z, float w, bool useShader = false);
+	void SetVector4f(UniformHandle name, const glm::vec4 &value, bool useShader = false);
+	void SetMatrix4(UniformHandle name, const glm::mat4 &matrix, bool useShader = false);
+	// Returns the location of a uniform, -1 if the program has no such active uniform
+	int GetUniformLocation(UniformHandle name) const;
+	// Starts counting lookups from zero, e.g. once per frame
+	static void ResetCounters();
 private:
+	// Uniforms reflected after linking; shared by all copies of this shader
+	std::shared_ptr<const UniformTable> uniforms;
+	// Builds the uniform table from the program's active uniforms
+	void reflectUniforms();
 	// Checks if compilation or linking failed and if so, print the error logs
 	void checkCompileErrors(unsigned int object, std::string type);
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "SpriteBatch.h"
+#include "RenderState.h"
+
+#include <algorithm>
+#include <cstddef>
+
+SpriteBatch::SpriteBatch(Shader &shader, unsigned int capacity /*= 1024*/)
+	: DrawCalls(0), shader(shader), capacity(std::max(capacity, 1u)) // End grows it by doubling, so it can't start at 0
+{
+	this->initRenderData();
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	glDeleteVertexArrays(1, &this->quadVAO);
+	glDeleteBuffers(1, &this->quadVBO);
+	glDeleteBuffers(1, &this->instanceVBO);
+}
+
+void SpriteBatch::Begin()
+{
+	this->items.clear();
+}
+
+void SpriteBatch::Submit(const Texture2D &texture, glm::vec2 position, glm::vec2 size /*= glm::vec2(10.0f, 10.0f)*/, float rotate /*= 0.0f*/, glm::vec3 color /*= glm::vec3(1.0f)*/)
+{
+	Item item;
+	item.Texture = texture.ID;
+	item.Instance.Rect = glm::vec4(position, size);
+	item.Instance.Color = glm::vec4(color, glm::radians(rotate));
+	item.Instance.Region = texture.Region;
+	this->items.push_back(item);
+}
+
+void SpriteBatch::End()
+{
+	this->DrawCalls = 0;
+	if (this->items.empty())
+		return;
+	// Group sprites by texture; the stable sort keeps submission order within a texture
+	std::stable_sort(this->items.begin(), this->items.end(),
+		[](const Item &a, const Item &b) { return a.Texture < b.Texture; });
+
+	unsigned int count = static_cast<unsigned int>(this->items.size());
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	if (count > this->capacity)
+	{
+		// Grow the instance buffer geometrically so it settles after a few frames
+		while (this->capacity < count)
+			this->capacity *= 2;
+		glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+	}
+	// Orphan the previous contents so the driver doesn't stall on draws still in flight
+	void *mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(SpriteInstance),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped)
+	{
+		SpriteInstance *instances = static_cast<SpriteInstance *>(mapped);
+		for (unsigned int i = 0; i < count; ++i)
+			instances[i] = this->items[i].Instance;
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
+
+	this->shader.Use();
+	RenderState::ActiveTexture(GL_TEXTURE0);
+	RenderState::BindVertexArray(this->quadVAO);
+	// One instanced draw per run of sprites sharing a texture
+	unsigned int first = 0;
+	while (first < count)
+	{
+		unsigned int last = first + 1;
+		while (last < count && this->items[last].Texture == this->items[first].Texture)
+			++last;
+		RenderState::BindTexture2D(this->items[first].Texture);
+		this->setInstanceOffset(first);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, last - first);
+		++this->DrawCalls;
+		first = last;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::initRenderData()
+{
+	// Configure VAO/VBO
+	float vertices[] =
+	{
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 0.0f,
+
+		0.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 0.0f
+	};
+
+	glGenVertexArrays(1, &this->quadVAO);
+	glGenBuffers(1, &this->quadVBO);
+	glGenBuffers(1, &this->instanceVBO);
+
+	RenderState::BindVertexArray(this->quadVAO);
+	// Static unit quad shared by every instance
+	glBindBuffer(GL_ARRAY_BUFFER, this->quadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	// Streaming instance buffer, advanced once per instance
+	glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+	glBufferData(GL_ARRAY_BUFFER, this->capacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+	this->setInstanceOffset(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::setInstanceOffset(unsigned int first)
+{
+	// OpenGL 3.3 has no base instance, so rebase the attribute pointers instead
+	size_t offset = first * sizeof(SpriteInstance);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, Rect)));
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, Color)));
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(offset + offsetof(SpriteInstance, Region)));
+}
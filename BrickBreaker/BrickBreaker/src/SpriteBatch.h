@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "Texture.h"
+
+// Per-instance sprite data as it is laid out in the instance buffer
+struct SpriteInstance
+{
+	glm::vec4 Rect;  // <vec2 position, vec2 size>
+	glm::vec4 Color; // <vec3 color, float rotation in radians>
+	glm::vec4 Region; // <vec2 offset, vec2 scale> of the texture coordinates, see Texture2D::Region
+};
+
+// SpriteBatch collects all sprites submitted between Begin and End and
+// renders them with instanced draw calls: the quads are sorted by texture,
+// streamed into a single instance buffer and drawn with one call per
+// texture, instead of one call (and a full set of state changes) per sprite.
+// Sprites whose textures share an atlas page count as the same texture.
+class SpriteBatch
+{
+public:
+	// Number of draw calls issued by the last End
+	unsigned int DrawCalls;
+
+	SpriteBatch(Shader &shader, unsigned int capacity = 1024);
+	~SpriteBatch();
+	// Owns its GL buffers and vertex array, which a copy would delete a second time
+	SpriteBatch(const SpriteBatch &) = delete;
+	SpriteBatch &operator=(const SpriteBatch &) = delete;
+	// Starts collecting sprites
+	void Begin();
+	// Queues a sprite; nothing is drawn until End
+	void Submit(const Texture2D &texture, glm::vec2 position,
+		glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f,
+		glm::vec3 color = glm::vec3(1.0f));
+	// Sorts, uploads and draws all queued sprites
+	void End();
+private:
+	// A queued sprite and the texture it is drawn with
+	struct Item
+	{
+		unsigned int Texture;
+		SpriteInstance Instance;
+	};
+	// Render state
+	Shader shader;
+	unsigned int quadVAO;
+	unsigned int quadVBO;
+	unsigned int instanceVBO;
+	unsigned int capacity; // Number of instances the instance buffer can hold
+	std::vector<Item> items;
+	// Initializes the quad mesh, instance buffer and vertex attributes
+	void initRenderData();
+	// Points the instance attributes at the instance with the given index
+	void setInstanceOffset(unsigned int first);
+};
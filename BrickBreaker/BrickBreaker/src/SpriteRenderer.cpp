@@ -1,4 +1,10 @@
 #include "SpriteRenderer.h"
+#include "RenderState.h"
+
+// Uniforms set for every sprite, hashed at compile time
+constexpr UniformHandle MODEL_UNIFORM("model");
+constexpr UniformHandle SPRITE_COLOR_UNIFORM("spriteColor");
+constexpr UniformHandle REGION_UNIFORM("region");
 
 SpriteRenderer::SpriteRenderer(Shader &shader)
 {
@@ -24,15 +30,15 @@ void SpriteRenderer::DrawSprite(const Texture2D &texture, glm::vec2 position, gl
 
 	model = glm::scale(model, glm::vec3(size, 1.0f));
 
-	this->shader.SetMatrix4("model", model);
-	this->shader.SetVector3f("spriteColor", color);
+	this->shader.SetMatrix4(MODEL_UNIFORM, model);
+	this->shader.SetVector3f(SPRITE_COLOR_UNIFORM, color);
+	this->shader.SetVector4f(REGION_UNIFORM, texture.Region);
 
-	glActiveTexture(GL_TEXTURE0);
+	RenderState::ActiveTexture(GL_TEXTURE0);
 	texture.Bind();
 
-	glBindVertexArray(this->quadVAO);
+	RenderState::BindVertexArray(this->quadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
-	glBindVertexArray(0);
 }
 
 void SpriteRenderer::initRenderData()
@@ -56,9 +62,8 @@ void SpriteRenderer::initRenderData()
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
-	glBindVertexArray(this->quadVAO);
+	RenderState::BindVertexArray(this->quadVAO);
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
 }
@@ -1,31 +1,33 @@
 #include <iostream>
 
 #include "Texture.h"
+#include "RenderState.h"
 
 Texture2D::Texture2D()
-	:Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR)
+	:ID(0), Width(0), Height(0), Internal_Format(GL_RGB), Image_Format(GL_RGB), Wrap_S(GL_REPEAT), Wrap_T(GL_REPEAT), Filter_Min(GL_LINEAR), Filter_Max(GL_LINEAR), Region(0.0f, 0.0f, 1.0f, 1.0f)
 {
-	glGenTextures(1, &this->ID);
+
 }
 
-void Texture2D::Generate(unsigned int width, unsigned int height, unsigned char* data)
+void Texture2D::Generate(unsigned int width, unsigned int height, const unsigned char* data)
 {
+	// The GL texture object is only created once there is image data for it
+	if (this->ID == 0)
+		glGenTextures(1, &this->ID);
 	this->Width = width;
 	this->Height = height;
 	// Create texture
-	glBindTexture(GL_TEXTURE_2D, this->ID);
+	RenderState::BindTexture2D(this->ID);
 	glTexImage2D(GL_TEXTURE_2D, 0, this->Internal_Format, width, height, 0, this->Image_Format, GL_UNSIGNED_BYTE, data);
 	// Set Texture wrap and filter modes
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->Wrap_S);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->Wrap_T);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->Filter_Min);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->Filter_Max);
-	// Unbind Texture
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Texture2D::Bind() const
 {
-	glBindTexture(GL_TEXTURE_2D, this->ID);
+	RenderState::BindTexture2D(this->ID);
 }
 
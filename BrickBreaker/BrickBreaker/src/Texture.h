@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
 
 class Texture2D
 {
@@ -17,10 +18,13 @@ public:
 	unsigned int Wrap_T; // Wrapping mode on T axis
 	unsigned int Filter_Min; // Filtering mode if texture pixels < screen pixels
 	unsigned int Filter_Max; // Filtering mode if texture pixels > screen pixels
-	// Constructor (default texture modes)
+	// Part of the texture object this texture covers, as <vec2 offset, vec2 scale> applied to
+	// texture coordinates; the whole object by default, a sub-rectangle for atlas images
+	glm::vec4 Region;
+	// Constructor (default texture modes); no GL object is created until Generate
 	Texture2D();
 	// Generates texture from image data
-	void Generate(unsigned int width, unsigned int height, unsigned char* data);
+	void Generate(unsigned int width, unsigned int height, const unsigned char* data);
 	// Binds the texture as the current active GL_TEXTURE_2D texture object
 	void Bind() const;
 };
\ No newline at end of file
@@ -0,0 +1,276 @@
+#include "TextureAtlas.h"
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <stb_image.h>
+
+// imgui_draw.cpp compiles its own static copy of the packer, so this one doesn't clash with it
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+// Pixels of edge padding around every image
+const int ATLAS_GUTTER = 2;
+// Identifies atlas cache files and their layout
+const char ATLAS_CACHE_MAGIC[4] = { 'B', 'B', 'A', 'T' };
+const uint32_t ATLAS_CACHE_VERSION = 2;
+
+namespace
+{
+	// Size and modification time of a source file, to tell if the cache is stale
+	struct SourceStamp
+	{
+		uint64_t Size;
+		int64_t Time;
+	};
+
+	bool stampSource(const std::string &file, SourceStamp &stamp)
+	{
+		std::error_code error;
+		stamp.Size = std::filesystem::file_size(file, error);
+		if (error)
+			return false;
+		stamp.Time = std::filesystem::last_write_time(file, error).time_since_epoch().count();
+		return !error;
+	}
+
+	template <typename T>
+	void write(std::ofstream &out, const T &value)
+	{
+		out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool read(std::ifstream &in, T &value)
+	{
+		return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+	}
+
+	void writeString(std::ofstream &out, const std::string &value)
+	{
+		write(out, static_cast<uint32_t>(value.size()));
+		out.write(value.data(), value.size());
+	}
+
+	bool readString(std::ifstream &in, std::string &value)
+	{
+		uint32_t size;
+		if (!read(in, size) || size > 4096)
+			return false;
+		value.resize(size);
+		return static_cast<bool>(in.read(&value[0], size));
+	}
+}
+
+TextureAtlas::TextureAtlas(unsigned int pageSize /*= 2048*/)
+	: PageSize(pageSize)
+{
+
+}
+
+bool TextureAtlas::Build(const std::vector<AtlasSource> &sources, const AssetPack *pack /*= nullptr*/)
+{
+	this->Regions.assign(sources.size(), { 0, 0, 0, 0, 0 });
+	this->Pages.clear();
+	// Take cooked pixels from the pack or decode the file; sources without alpha come out opaque
+	std::vector<const unsigned char *> images(sources.size(), nullptr);
+	std::vector<int> imageChannels(sources.size(), 4);
+	std::vector<unsigned char *> decoded;
+	std::vector<stbrp_rect> rects(sources.size());
+	bool ok = true;
+	for (unsigned int i = 0; i < sources.size() && ok; ++i)
+	{
+		int width, height, channels;
+		const PackEntry *cooked = pack && pack->IsOpen() ? pack->Find(sources[i].File, PACK_TEXTURE) : nullptr;
+		if (cooked && (cooked->Channels == 3 || cooked->Channels == 4))
+		{
+			images[i] = pack->Data(*cooked);
+			imageChannels[i] = cooked->Channels;
+			width = cooked->Width;
+			height = cooked->Height;
+		}
+		else
+		{
+			unsigned char *image = stbi_load(sources[i].File.c_str(), &width, &height, &channels, 4);
+			if (image)
+				decoded.push_back(image);
+			images[i] = image;
+		}
+		if (!images[i])
+		{
+			std::cerr << "ERROR::ATLAS: Failed to load texture file: " << sources[i].File << std::endl;
+			ok = false;
+			break;
+		}
+		this->Regions[i].Width = width;
+		this->Regions[i].Height = height;
+		rects[i].id = i;
+		rects[i].w = width + 2 * ATLAS_GUTTER;
+		rects[i].h = height + 2 * ATLAS_GUTTER;
+		rects[i].was_packed = 0;
+	}
+
+	// Fill one page at a time with whatever still fits
+	std::vector<stbrp_node> nodes(this->PageSize);
+	std::vector<stbrp_rect> pending = rects;
+	while (ok && !pending.empty())
+	{
+		unsigned int page = static_cast<unsigned int>(this->Pages.size());
+		stbrp_context context;
+		stbrp_init_target(&context, this->PageSize, this->PageSize, nodes.data(), static_cast<int>(nodes.size()));
+		stbrp_pack_rects(&context, pending.data(), static_cast<int>(pending.size()));
+		// Shrink the page to what was used
+		AtlasPage result = {};
+		std::vector<stbrp_rect> left;
+		for (const stbrp_rect &rect : pending)
+		{
+			if (!rect.was_packed)
+			{
+				left.push_back(rect);
+				continue;
+			}
+			AtlasRegion &region = this->Regions[rect.id];
+			region.Page = page;
+			region.X = rect.x + ATLAS_GUTTER;
+			region.Y = rect.y + ATLAS_GUTTER;
+			result.Width = std::max(result.Width, static_cast<unsigned int>(rect.x + rect.w));
+			result.Height = std::max(result.Height, static_cast<unsigned int>(rect.y + rect.h));
+		}
+		if (left.size() == pending.size())
+		{
+			std::cerr << "ERROR::ATLAS: Texture larger than an atlas page: " << sources[pending[0].id].File << std::endl;
+			ok = false;
+			break;
+		}
+		result.Pixels.assign(static_cast<size_t>(result.Width) * result.Height * 4, 0);
+		this->Pages.push_back(std::move(result));
+		pending.swap(left);
+	}
+
+	// Copy every image into its page, clamping coordinates to extrude the edges into the gutter
+	for (unsigned int i = 0; i < sources.size() && ok; ++i)
+	{
+		const AtlasRegion &region = this->Regions[i];
+		AtlasPage &page = this->Pages[region.Page];
+		int width = region.Width, height = region.Height;
+		for (int y = -ATLAS_GUTTER; y < height + ATLAS_GUTTER; ++y)
+		{
+			int sourceY = std::min(std::max(y, 0), height - 1);
+			for (int x = -ATLAS_GUTTER; x < width + ATLAS_GUTTER; ++x)
+			{
+				int sourceX = std::min(std::max(x, 0), width - 1);
+				const unsigned char *from = images[i] + (static_cast<size_t>(sourceY) * width + sourceX) * imageChannels[i];
+				unsigned char *to = &page.Pixels[(static_cast<size_t>(region.Y + y) * page.Width + region.X + x) * 4];
+				std::memcpy(to, from, imageChannels[i]);
+				if (imageChannels[i] == 3 || !sources[i].Alpha)
+					to[3] = 255;
+			}
+		}
+	}
+	for (unsigned char *image : decoded)
+		stbi_image_free(image);
+	if (!ok)
+	{
+		this->Regions.clear();
+		this->Pages.clear();
+	}
+	return ok;
+}
+
+bool TextureAtlas::Load(const char *cacheFile, const std::vector<AtlasSource> &sources)
+{
+	std::ifstream in(cacheFile, std::ios::binary);
+	if (!in)
+		return false;
+	char magic[4];
+	uint32_t version, pageSize, sourceCount;
+	if (!in.read(magic, 4) || std::memcmp(magic, ATLAS_CACHE_MAGIC, 4) != 0
+		|| !read(in, version) || version != ATLAS_CACHE_VERSION
+		|| !read(in, pageSize) || pageSize != this->PageSize
+		|| !read(in, sourceCount) || sourceCount != sources.size())
+		return false;
+	// The cache is only valid for the same images, unchanged since it was written
+	for (const AtlasSource &source : sources)
+	{
+		std::string name, file;
+		uint8_t alpha;
+		SourceStamp cached, current;
+		if (!readString(in, name) || !readString(in, file) || !read(in, alpha)
+			|| !read(in, cached.Size) || !read(in, cached.Time))
+			return false;
+		if (name != source.Name || file != source.File || alpha != source.Alpha
+			|| !stampSource(source.File, current) || current.Size != cached.Size || current.Time != cached.Time)
+			return false;
+	}
+	std::vector<AtlasRegion> regions(sources.size());
+	for (AtlasRegion &region : regions)
+	{
+		uint32_t values[5];
+		if (!read(in, values))
+			return false;
+		region = { values[0], values[1], values[2], values[3], values[4] };
+	}
+	uint32_t pageCount;
+	if (!read(in, pageCount) || pageCount > sources.size())
+		return false;
+	std::vector<AtlasPage> pages(pageCount);
+	for (AtlasPage &page : pages)
+	{
+		uint32_t width, height;
+		if (!read(in, width) || !read(in, height) || width > pageSize || height > pageSize)
+			return false;
+		page.Width = width;
+		page.Height = height;
+		page.Pixels.resize(static_cast<size_t>(width) * height * 4);
+		if (!in.read(reinterpret_cast<char *>(page.Pixels.data()), page.Pixels.size()))
+			return false;
+	}
+	for (const AtlasRegion &region : regions)
+	{
+		if (region.Page >= pageCount || region.X + region.Width > pages[region.Page].Width
+			|| region.Y + region.Height > pages[region.Page].Height)
+			return false;
+	}
+	this->Regions.swap(regions);
+	this->Pages.swap(pages);
+	return true;
+}
+
+bool TextureAtlas::Save(const char *cacheFile, const std::vector<AtlasSource> &sources) const
+{
+	std::ofstream out(cacheFile, std::ios::binary | std::ios::trunc);
+	if (!out)
+		return false;
+	out.write(ATLAS_CACHE_MAGIC, 4);
+	write(out, ATLAS_CACHE_VERSION);
+	write(out, static_cast<uint32_t>(this->PageSize));
+	write(out, static_cast<uint32_t>(sources.size()));
+	for (const AtlasSource &source : sources)
+	{
+		SourceStamp stamp = { 0, 0 };
+		stampSource(source.File, stamp);
+		writeString(out, source.Name);
+		writeString(out, source.File);
+		write(out, static_cast<uint8_t>(source.Alpha));
+		write(out, stamp.Size);
+		write(out, stamp.Time);
+	}
+	for (const AtlasRegion &region : this->Regions)
+	{
+		uint32_t values[5] = { region.Page, region.X, region.Y, region.Width, region.Height };
+		write(out, values);
+	}
+	write(out, static_cast<uint32_t>(this->Pages.size()));
+	for (const AtlasPage &page : this->Pages)
+	{
+		write(out, static_cast<uint32_t>(page.Width));
+		write(out, static_cast<uint32_t>(page.Height));
+		out.write(reinterpret_cast<const char *>(page.Pixels.data()), page.Pixels.size());
+	}
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+class AssetPack;
+
+// An image to pack into an atlas
+struct AtlasSource
+{
+	std::string Name;
+	std::string File;
+	bool Alpha;
+};
+
+// Where a packed image ended up, in pixels
+struct AtlasRegion
+{
+	unsigned int Page;
+	unsigned int X, Y, Width, Height;
+};
+
+// An RGBA atlas page
+struct AtlasPage
+{
+	unsigned int Width, Height;
+	std::vector<unsigned char> Pixels;
+};
+
+// TextureAtlas packs many small images into a few large RGBA pages so that
+// sprites using different images can share a texture and be drawn together.
+// Every image is surrounded by a gutter filled with its own edge pixels, so
+// linear filtering never picks up a neighbour. A packed atlas can be saved
+// to and loaded from a cache file to skip decoding and packing on startup.
+class TextureAtlas
+{
+public:
+	// Largest width and height of a page
+	unsigned int PageSize;
+	// One region per source, in source order
+	std::vector<AtlasRegion> Regions;
+	std::vector<AtlasPage> Pages;
+
+	TextureAtlas(unsigned int pageSize = 2048);
+	// Loads and packs the sources, taking cooked pixels from pack where it has them;
+	// false if a source can't be loaded or doesn't fit on a page
+	bool Build(const std::vector<AtlasSource> &sources, const AssetPack *pack = nullptr);
+	// Loads a cached atlas; false if there's none or it was built from other sources or files
+	bool Load(const char *cacheFile, const std::vector<AtlasSource> &sources);
+	// Saves the atlas along with what it was built from
+	bool Save(const char *cacheFile, const std::vector<AtlasSource> &sources) const;
+};
\ No newline at end of file